@@ -78,30 +78,71 @@ WRITE:
  - Wait on BUSY
 */
 //-----------------------------------------------------------------------------
-void flash_erase_page(uint16_t *page)
+// The asynchronous operations are called by the flash engine in the FLASH
+// interrupt, which runs from SRAM, see flash_engine.h
+//-----------------------------------------------------------------------------
+__ramfunc void flash_erase_start(uint32 addr)
 {
-	// Unlock Flash with magic keys
-	flash_unlock();
 	flash_wait_for_ready();
-
-	// Erase page
-	flash_set_cr(FLASH_CR_PER); // erase page flag
-	flash_set_page((uint32_t) page);
+	FLASH->SR = FLASH_SR_EOP | FLASH_SR_PGERR | FLASH_SR_WRPRTERR; // write 1 to clear
+	FLASH->CR = (FLASH->CR & FLASH_CR_EOPIE) | FLASH_CR_PER;
+	flash_set_page(addr);
 	flash_start();
+}
 
+//-----------------------------------------------------------------------------
+__ramfunc void flash_program_start(uint32 addr, uint16 value)
+{
 	flash_wait_for_ready();
+	FLASH->SR = FLASH_SR_EOP | FLASH_SR_PGERR | FLASH_SR_WRPRTERR;
+	FLASH->CR = (FLASH->CR & FLASH_CR_EOPIE) | FLASH_CR_PG;
+	*(volatile uint16 *)addr = value;
 }
 
 //-----------------------------------------------------------------------------
-void flash_write_data(uint16_t *page, uint16_t *data, uint16_t size)
+__ramfunc uint32 flash_poll(void)
 {
-	flash_set_cr(FLASH_CR_PG); // erase program flag
+	uint32 sr = FLASH->SR;
+	if ( sr & FLASH_SR_BSY )
+		return FLASH_BUSY;
 
+	FLASH->SR = sr & (FLASH_SR_EOP | FLASH_SR_PGERR | FLASH_SR_WRPRTERR);
+	FLASH->CR &= ~(FLASH_CR_PG | FLASH_CR_PER);
+
+	uint32 err = 0;
+	if ( sr & FLASH_SR_PGERR )
+		err |= FLASH_ERR_PG;
+	if ( sr & FLASH_SR_WRPRTERR )
+		err |= FLASH_ERR_WRP;
+	return err;
+}
+
+//-----------------------------------------------------------------------------
+__ramfunc uint32 flash_await(void)
+{
+	uint32 err;
+	while ( (err = flash_poll())==FLASH_BUSY );
+	return err;
+}
+
+//-----------------------------------------------------------------------------
+// blocking, returns the error flags
+//-----------------------------------------------------------------------------
+__ramfunc uint32 flash_erase_page(uint16_t *page)
+{
+	flash_unlock();
+	flash_erase_start((uint32)page);
+	return flash_await();
+}
+
+//-----------------------------------------------------------------------------
+__ramfunc uint32 flash_write_data(uint16_t *page, uint16_t *data, uint16_t size)
+{
+	uint32 err = 0;
 	while (size--)
 	{
-		*page++ = *data++;
-
-		flash_wait_for_ready();
+		flash_program_start((uint32)page++, *data++);
+		err |= flash_await();
 	}
+	return err;
 }
-
@@ -78,8 +78,24 @@ extern "C"{
  */
 
 extern void flash_set_latency(uint32 wait_states);
-void flash_erase_page(uint16_t *page);
-extern void flash_write_data(uint16_t *page, uint16_t *data, uint16_t size);
+extern uint32 flash_erase_page(uint16_t *page);
+extern uint32 flash_write_data(uint16_t *page, uint16_t *data, uint16_t size);
+
+/*
+ * Asynchronous operations, same behaviour on all families:
+ * flash_erase_start() / flash_program_start() wait for a previous operation,
+ * start the new one and return at once. flash_poll() returns FLASH_BUSY while
+ * it runs, then ends it and returns its error flags, 0 if done without error.
+ * The flash must be unlocked, FLASH_CR_EOPIE is kept as set by the caller.
+ */
+#define FLASH_BUSY		(1<<0)
+#define FLASH_ERR_PG	(1<<1)	// PGERR: address not erased (or wrong access)
+#define FLASH_ERR_WRP	(1<<2)	// WRPRTERR: page write protected
+
+extern void flash_erase_start(uint32 addr);
+extern void flash_program_start(uint32 addr, uint16 value);
+extern uint32 flash_poll(void);
+extern uint32 flash_await(void);
 
 /**
  * @brief Enable Flash memory features
@@ -109,18 +125,21 @@ static inline int flash_locked() {
 	return (FLASH->CR & FLASH_CR_LOCK);
 }
 
-static inline void flash_lock() {
-	FLASH->CR = FLASH_CR_LOCK;
+static inline void flash_wait_for_ready(void) {
+	while (FLASH->SR & FLASH_SR_BSY);
 }
 
-static inline void flash_unlock(void) {
-	// Unlock Flash with magic keys
-	FLASH->KEYR = FLASH_KEY1;
-	FLASH->KEYR = FLASH_KEY2;
+static inline void flash_lock() {
+	flash_wait_for_ready();
+	FLASH->CR = (FLASH->CR & ~(FLASH_CR_PG | FLASH_CR_PER)) | FLASH_CR_LOCK;
 }
 
-static inline void flash_wait_for_ready(void) {
-	while (FLASH->SR & FLASH_SR_BSY);
+static inline void flash_unlock(void) {
+	// Unlock Flash with magic keys, a key written while unlocked would lock the FPEC till reset
+	if ( flash_locked() ) {
+		FLASH->KEYR = FLASH_KEY1;
+		FLASH->KEYR = FLASH_KEY2;
+	}
 }
 
 static inline void flash_set_cr(int cr)
@@ -55,6 +55,7 @@ typedef void (*voidArgumentFuncPtr)(void *);
 
 #define __IO volatile
 #define __attr_flash __attribute__((section (".USER_FLASH")))
+#define __ramfunc __attribute__((section (".ramfunc"), noinline)) // executed from SRAM, see LinkerScript.ld
 #define __packed __attribute__((__packed__))
 #define __deprecated __attribute__((__deprecated__))
 #define __weak __attribute__((weak))
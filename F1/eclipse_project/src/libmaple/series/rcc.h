@@ -240,7 +240,7 @@ typedef struct rcc_reg_map {
 
 #define RCC_AHBENR_SDIOEN_BIT           10
 #define RCC_AHBENR_FSMCEN_BIT           8
-#define RCC_AHBENR_CRCEN_BIT            7
+#define RCC_AHBENR_CRCEN_BIT            6
 #define RCC_AHBENR_FLITFEN_BIT          4
 #define RCC_AHBENR_SRAMEN_BIT           2
 #define RCC_AHBENR_DMA2EN_BIT           1
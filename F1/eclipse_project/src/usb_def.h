@@ -4,7 +4,7 @@
 
 #include <stdbool.h>
 #include <stdint.h>
-
+#include "usb_desc.h"
 
 //#define USB_DEBUG 1
 
@@ -12,13 +12,8 @@
 // Drive USB as virtual COM port
 //-----------------------------------------------------------------------------
 
-/* For devices with 2 x 16 bits / uint16_t access schema (e.g. STM32L0, STM32F303xD and xE) */
-//#define UMEM_SHIFT 0
-//#define UMEM_FAKEWIDTH uint16_t
-
-/* For devices with 1 x 16 bits / uint16_t access schema (e.g. STM32F103, STM32F302, STM32F303xB and xC) */
-#define UMEM_SHIFT 1
-#define UMEM_FAKEWIDTH uint32
+/* The access scheme of the packet memory (UMEM_SHIFT, UMEM_FAKEWIDTH) is set in usb_traits.h */
+#include "usb_traits.h"
 
 /* The name of the IRQ handler must match startup_stm32.s */
 #define NAME_OF_USB_IRQ_HANDLER USB_LP_CAN_RX0_IRQHandler
@@ -26,6 +21,13 @@
 /* Take the number from the reference manual of your C. */
 #define USB_IRQ_NUMBER 20
 
+// Count frames and EP_DATA traffic per frame (SOF/ESOF interrupts), see CMD_STATS.
+// Off by default: the SOF interrupt fires every millisecond.
+#define USB_FRAME_STATS 0
+
+// Leave USB enumerated when jumping to the user program, see boot_handoff.h
+#define USB_KEEP_ON_HANDOFF 0
+
 // Enable trace messages
 #define ENABLE_TRACING 0
 
@@ -54,21 +56,14 @@
     }
 #else
 #include "systick.h"
-	#ifdef USB_DEBUG
-		extern void DoTrace(char *, int);
-		extern void NrTrace(int, int);
-		//#define trace(s) { char* dest = &dBuf[dLen]; dLen += (sizeof(s)-1); const char* src = s; for (uint32_t i=0; i<(sizeof(s)-1); i++) *dest++ = *src++; }
-		#define trace(s) DoTrace(s, sizeof(s)-1)
-		#define ntrace(d,nl) NrTrace(d, nl)
-		#define TIME_STAMP trace("["); NrTrace(millis(), 0); trace("]");
-	#else
-		#define trace(...)
-		#define ntrace(d,nl)
-		#define TIME_STAMP
-	#endif
+	// the USB_DEBUG build logs binary events with etrace(), see usb_trace.h
+	#define trace(...)
+	#define ntrace(d,nl)
 #define strace(...)
 #endif
 
+#include "usb_trace.h"
+
 
 //-----------------------------------------------------------------------------
 #define SET_BIT(REG, BIT)     ((REG) |= (BIT))
@@ -182,6 +177,9 @@
 #define  STAT_TX  (3<<4)
 #define  MASK_EP  (15)
 
+/* Bits in USB_FNR */
+#define  FNR_FN   (0x7FF)
+
 /* EndPoint Register Mask (No Toggle Fields) */
 #define  EP_MASK_NoToggleBits  (CTR_RX|SETUP|EP_TYPE|EP_KIND|CTR_TX|MASK_EP)
 
@@ -222,14 +220,17 @@
 // Allocation of the EP buffers
 #define USB_RAM       0x40006000
 /**/
-#define EP_CTRL_TX_BUF_ADDRESS	(USB_RAM + (EP_CTRL_TX_OFFSET<<UMEM_SHIFT))
-#define EP_CTRL_RX_BUF_ADDRESS	(USB_RAM + (EP_CTRL_RX_OFFSET<<UMEM_SHIFT))
+// the EP buffer at "offset" of the packet memory, as in the EP table
+#define PMA_ADDR(offset)		(USB_RAM + ((offset)<<UMEM_SHIFT))
+
+#define EP_CTRL_TX_BUF_ADDRESS	PMA_ADDR(EP_CTRL_TX_OFFSET)
+#define EP_CTRL_RX_BUF_ADDRESS	PMA_ADDR(EP_CTRL_RX_OFFSET)
 
-#define EP_DATA_TX_BUF_ADDRESS	(USB_RAM + (EP_DATA_TX_OFFSET<<UMEM_SHIFT))
-#define EP_DATA_RX_BUF_ADDRESS	(USB_RAM + (EP_DATA_RX_OFFSET<<UMEM_SHIFT))
+#define EP_DATA_TX_BUF_ADDRESS	PMA_ADDR(EP_DATA_TX_OFFSET)
+#define EP_DATA_RX_BUF_ADDRESS	PMA_ADDR(EP_DATA_RX_OFFSET)
 
-#define EP_COMM_TX_BUF_ADDRESS	(USB_RAM + (EP_COMM_TX_OFFSET<<UMEM_SHIFT))
-#define EP_COMM_RX_BUF_ADDRESS	(USB_RAM + (EP_COMM_RX_OFFSET<<UMEM_SHIFT))
+#define EP_COMM_TX_BUF_ADDRESS	PMA_ADDR(EP_COMM_TX_OFFSET)
+#define EP_COMM_RX_BUF_ADDRESS	PMA_ADDR(EP_COMM_RX_OFFSET)
 
 
 // EP table
@@ -241,16 +242,9 @@ typedef struct epTableEntry_t
     UMEM_FAKEWIDTH rxCount;
 } epTableEntry_t;
 
-typedef struct epTableAddress_t {
-    uint32_t * txAddr;
-    uint32_t * rxAddr;
-} epTableAddress_t;
-extern const epTableAddress_t epTableAddr[2]; // number of EPs
-
 #define EP_TABLE_OFFSET		400    // storing 64 bytes after 400
 
-#define EpTable   ((epTableEntry_t *) (USB_RAM + (EP_TABLE_OFFSET<<UMEM_SHIFT)))
-
+#define EpTable   ((epTableEntry_t *) PMA_ADDR(EP_TABLE_OFFSET))
 
 
 #endif // USB_DEF_H
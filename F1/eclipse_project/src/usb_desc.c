@@ -22,7 +22,7 @@
 #include <string.h>
 
 #include "usb_desc.h"
-#include "usbstd.h"
+#include "usb_std.h"
 #include "cdc.h"
 
 #define SERIAL_USB_ONLY // use CDC only. Uncomment for a combined device
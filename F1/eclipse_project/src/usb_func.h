@@ -8,6 +8,8 @@
 #include "cdc.h"
 #include "gpio.h"
 #include "flash.h"
+#include "dwt.h"
+#include "boot_handoff.h"
 
 /******* Struktur des Setup-Paketes *****/
 typedef struct
@@ -32,6 +34,16 @@ typedef struct
     int configuration;
 } command_t;
 
+typedef union status_t {
+	// access as 16 bit in one read instruction
+	uint16_t both;
+	// -- or as separate 8 bit values --
+	struct {
+		uint8_t suspended;
+		uint8_t configured;
+	};
+} status_t;
+
 /* Line coding structure
  0-3 BaudRate     Data terminal rate (baudrate), in bits per second
  4   bCharFormat  Stop bits: 0 - 1 Stop bit, 1 - 1.5 Stop bits, 2 - 2 Stop bits
@@ -47,7 +59,6 @@ extern uint16_t Dtr_Rts;
 extern const uint8_t ZERO;
 
 extern void Class_Start(void);
-extern void EnableUsbIRQ();
 extern void Setup_flash();
 extern void Setup_clocks();
 
@@ -55,6 +66,17 @@ extern int DataBeginTransmit();
 extern void DataBeginReceive(); // called when Rx data can be processed again
 extern int ReadControlBlock(uint8_t* pBuffer, int maxlen);
 extern int SendData(int ep, uint8_t* pBuffer, int count);
+extern void USB_save_state(boot_handoff_t * h);
+//--------------------------------------------------------------------------
+static inline void EnableUsbIRQ (void)
+{
+    NVIC_ISER[USB_IRQ_NUMBER/32] = ((uint32_t) 1) << (USB_IRQ_NUMBER % 32);
+}
+//--------------------------------------------------------------------------
+static inline void DisableUsbIRQ (void)
+{
+    NVIC_ICER[USB_IRQ_NUMBER/32] = ((uint32_t) 1) << (USB_IRQ_NUMBER % 32);
+}
 //--------------------------------------------------------------------------
 static inline void ACK(void)
 {
@@ -96,7 +118,7 @@ static inline bool IsVendorRequest(void)
 #define FLASH_BASE			(0x08000000)
 #define SRAM_BASE			(0x20000000)
 // Bootloader size
-#define BOOTLOADER_SIZE		(4 * 1024)
+#define BOOTLOADER_SIZE		(8 * 1024)
 
 // SRAM size
 #define SRAM_SIZE			(20 * 1024)
@@ -104,8 +126,14 @@ static inline bool IsVendorRequest(void)
 // SRAM end (bottom of stack)
 #define SRAM_END			(SRAM_BASE + SRAM_SIZE)
 
-// CDC Bootloader takes 4 kb flash.
+// CDC Bootloader takes 8 kb flash.
 #define USER_PROGRAM		(FLASH_BASE + BOOTLOADER_SIZE)
+
+// flash size (STM32F103C8) and the staging region at its end, see staging.h
+#define FLASH_SIZE			(64 * 1024)
+#define STAGING_SIZE		(28 * 1024)
+// 1: slot B is copied to USER_PROGRAM when activated, 0: both slots are executed in place
+#define BOOT_SLOT_SWAP		1
 //-----------------------------------------------------------------------------
 typedef union cmd_t {
 	uint8_t data[8];
@@ -119,8 +147,48 @@ typedef union cmd_t {
 } __attribute((packed)) cmd_t;
 extern cmd_t cmd;
 
+// data stage of CMD_IMAGE
+typedef struct image_info_t {
+	uint32_t len;		// image length in bytes
+	uint16_t checksum;	// Calculate_CRC() of the image
+	uint16_t reserved;
+} __attribute((packed)) image_info_t;
+
+// entry of the segment table of CMD_SEGMENTS
+typedef struct segment_t {
+	uint32_t addr;		// flash address, page aligned
+	uint32_t len;		// bytes
+	uint32_t crc32;		// CRC-32 of the segment, as Image_crc()
+} __attribute((packed)) segment_t;
+#define SEGMENTS_MAX		4
+
+// command ids
+enum {
+	CMD_SESSION = 0x20,	// start of upload session, page = number of pages to flash, data_len = image version
+	CMD_PAGE = 0x21,	// page data follows, page = page number, data_len = number of bytes
+	CMD_STATS = 0x22,	// send back the frame statistics (usb_stats_t)
+	CMD_RUN = 0x23,		// end the session and start the program, data_len = vector table in pages from FLASH_BASE, 0 = active slot
+	CMD_RESET = 0x24,	// end the session and reset the MCU
+	CMD_SEGMENTS = 0x25,	// start of a segment session, page = number of segments, data_len = image version, the segment table follows
+	CMD_PATCH = 0x26,	// write bytes in place (read-modify-write of the page), data_len = number of bytes, the address (uint32_t) and the bytes follow
+	CMD_IMAGE = 0x27,	// optional, within a session: the image length and checksum (image_info_t) follow
+};
+
 #define PAGE_SIZE	1024
 extern int Check_CRC(uint8_t * buff, int len);
+extern int Calculate_CRC(uint8_t * buff, int len);
+extern void Ramfunc_load(void); // the __ramfunc code, before its first use (boot.c)
+
+// USB start-up (main.c) and the serial mode for the user program (see boot_api.h)
+extern void GpioToggle(void);
+extern void UsbSetup(void);
+extern void NAME_OF_USB_IRQ_HANDLER(void);
+extern status_t usb_state;
+extern bool usb_serial;
+extern bool Cdc_connected(void);
+extern int Cdc_available(void);
+extern int Cdc_read(uint8_t * buf, int max);
+extern int Cdc_write(const uint8_t * buf, int len);
 
 #define BAUD_RATE 230400
 
@@ -133,7 +201,12 @@ typedef enum {
 	DATA_UNDEFLOW,
 	CMD_WRONG_LENGTH,
 	CMD_WRONG_CRC,
-	CMD_WRONG_ID
+	CMD_WRONG_ID,
+	CMD_WRONG_ADDRESS,
+	FLASH_VERIFY_FAILED,	// followed by the failing address (uint32_t), see flash_engine.h
+	SEGMENT_CRC_FAILED,	// followed by the index of the segment (uint8_t)
+	PATCH_NEEDS_ERASE,	// CMD_PATCH sets bits, not possible with the sector erase (F4)
+	ACTIVATE_FAILED		// followed by the STAGE_ERR_xxx of the activation (uint8_t), see staging.h
 } error_t;
 
 typedef struct buf_params_t {
@@ -143,9 +216,40 @@ typedef struct buf_params_t {
 } buf_params_t;
 extern buf_params_t buf_params[2];
 
+// frame statistics, see OnSof()
+#define USB_STATS_HIST	16
+
+typedef struct usb_stats_t {
+	uint32_t frames;		// number of elapsed frames (1 ms each)
+	uint32_t missed_sofs;	// number of ESOF events
+	uint32_t data_frames;	// frames with traffic on EP_DATA
+	uint32_t idle_frames;	// frames without traffic on EP_DATA during an upload
+	uint32_t bytes;			// bytes moved on EP_DATA (both directions)
+	uint32_t config_us;		// time from reset to the first SET_CONFIGURATION, see Boot_time_us()
+	uint16_t max_frame_bytes;	// most bytes moved within one frame
+	uint16_t hist[USB_STATS_HIST];	// frames by number of EP_DATA packets, the last entry counts all above
+	uint32_t verify_us;		// time spent in the read-back verify of the flash writes
+	uint32_t verify_retries;	// pages erased and written again after a failed verify
+} usb_stats_t;
+extern usb_stats_t usb_stats;
+
+// The DWT cycle counter is started at reset. The clock setup runs from HSI,
+// its cycles are stored in clock_cycles, then the counter restarts at F_CPU.
+#define HSI_MHZ			8
+extern uint32_t clock_cycles;
+static inline uint32_t Boot_time_us(void)
+{
+	return clock_cycles/HSI_MHZ + dwt_cycles()/(F_CPU/1000000);
+}
+
 extern int num_pages; // number of total pages to flash
 extern int crt_page, page_offset;
+extern uint32_t upload_base; // slot the upload is written into
+extern uint16_t upload_version;
+extern uint32_t run_address; // CMD_RUN, 0 = active slot
 extern int header_ok;
+extern bool Upload_activate(void);
+extern void Command_activate(void);
 //-----------------------------------------------------------------------------
 
 
@@ -0,0 +1,62 @@
+/*
+ * usb_traits.h
+ *
+ * STM32F1 specific part of the USB FS device driver in common/usb.c.
+ * The driver is written against the CMSIS register bit names, here they are
+ * mapped to the definitions from usb_def.h. Everything is resolved by the
+ * preprocessor, there is no runtime cost.
+ */
+
+#ifndef USB_TRAITS_H
+#define USB_TRAITS_H
+
+// the USB registers are 16 bit wide, but they must be accessed as 32 bit data
+typedef uint32_t usb_reg_t;
+
+// packet memory with 1 x 16 bit per 32 bit word: each 16 bit word of the
+// buffers and the EP table takes 32 bit of the address space
+#define UMEM_SHIFT					1
+#define UMEM_FAKEWIDTH				uint32_t
+
+/* Bits in USB_CNTR */
+#define USB_CNTR_LPMODE				USB_CNTR_LP_MODE
+
+/* Bits in USB_ISTR */
+#define USB_ISTR_CTR				CTR
+#define USB_ISTR_PMAOVR				PMAOVR
+#define USB_ISTR_ERR				ERR
+#define USB_ISTR_WKUP				WKUP
+#define USB_ISTR_SUSP				SUSP
+#define USB_ISTR_RESET				RESET
+#define USB_ISTR_SOF				SOF
+#define USB_ISTR_ESOF				ESOF
+#define USB_ISTR_DIR				DIR
+#define USB_EPADDR_FIELD			MASK_EP
+
+/* Bits in USB_EPnR */
+#define USB_EP_CTR_RX				CTR_RX
+#define USB_EP_CTR_TX				CTR_TX
+#define USB_EP_SETUP				SETUP
+#define USB_EPRX_STAT				STAT_RX
+#define USB_EPTX_STAT				STAT_TX
+#define USB_EP_DTOG_RX				DTOG_RX
+#define USB_EP_DTOG_TX				DTOG_TX
+#define USB_EPREG_NO_TOGGLE_MASK	EP_MASK_NoToggleBits
+
+/* Values of the STAT_RX / STAT_TX fields */
+#define USB_EP_RX_DIS				(0<<12)
+#define USB_EP_RX_STALL				(1<<12)
+#define USB_EP_RX_NAK				(2<<12)
+#define USB_EP_RX_VALID				(3<<12)
+#define USB_EP_TX_DIS				(0<<4)
+#define USB_EP_TX_STALL				(1<<4)
+#define USB_EP_TX_NAK				(2<<4)
+#define USB_EP_TX_VALID				(3<<4)
+
+/* Bits in USB_FNR */
+#define USB_FNR_FN					FNR_FN
+
+// the page number in the page header is ignored, pages are written one after the other
+#define USB_PAGE_FROM_HEADER		0
+
+#endif // USB_TRAITS_H
@@ -44,7 +44,7 @@ extern "C"{
 #include "rcc.h"
 #include "nvic.h"
 #include "ring_buffer.h"
-#include "..\cdc.h"
+#include "cdc.h"
 
 
 /*
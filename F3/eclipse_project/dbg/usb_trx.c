@@ -9,34 +9,29 @@ RING_BUFFER(txBuf, 256);
 
 
 #ifdef USB_DEBUG
-#define DBG_SIZE 10000
-	char dBuf[DBG_SIZE];
-	int dLen = 0;
-#define DIGITS_SIZE 10
-	char digits[DIGITS_SIZE];
+#include "usart.h"
 
-void DoTrace(char * s, int len)
+//-----------------------------------------------------------------------------
+// output the logged records to USART1, oldest first.
+// Format: "TRC1 <nr of records> <lost records> <F_CPU>\n" followed by the raw records.
+//-----------------------------------------------------------------------------
+void TraceDump(void)
 {
-	if ( (dLen+len)>DBG_SIZE )
-		return;
-
-	char* dest = &dBuf[dLen];
-	dLen += len;
-	const char* src = s;
-	while (len--)
-		*dest++ = *src++;
-}
-void NrTrace(int val, int nl)
-{
-	int i = DIGITS_SIZE-1;
-	if (nl)
-		digits[i--] = '\n';
-	do {
-		digits[i--] = val % 10 + '0';
-		val /= 10;
-	} while (val > 0 && i>=0);
-	i++;
-	DoTrace(&digits[i], DIGITS_SIZE-i);
+	uint32_t cnt = trace_cnt; // events logged meanwhile may overwrite the oldest records
+	uint32_t first = 0;
+	if (cnt > TRACE_SIZE)
+		first = cnt - TRACE_SIZE;
+
+	usart_putstr(USART1, "TRC1 ");
+	usart_putudec(USART1, cnt - first); usart_putc(USART1, ' ');
+	usart_putudec(USART1, first); usart_putc(USART1, ' ');
+	usart_putudec(USART1, F_CPU); usart_putc(USART1, '\n');
+
+	while (first < cnt)
+	{
+		usart_tx(USART1, (uint8 *)&trace_buf[first & (TRACE_SIZE-1)], sizeof(trace_rec_t));
+		first++;
+	}
 }
 #endif
 
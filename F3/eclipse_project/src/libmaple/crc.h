@@ -0,0 +1,60 @@
+/**
+ * @file libmaple/crc.h
+ * @brief CRC calculation unit.
+ *
+ * CRC-32 (Ethernet polynomial 0x04C11DB7, initial value 0xFFFFFFFF),
+ * fed with 32-bit words, no bit reversal and no final XOR.
+ * This is the reset configuration of the F3 unit, same as on the F1.
+ */
+
+#ifndef _LIBMAPLE_CRC_H_
+#define _LIBMAPLE_CRC_H_
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+#include "libmaple_types.h"
+#include "util.h"
+#include "rcc.h"
+#include "stm32f3xx.h"
+
+/** CRC register map base pointer (CRC_reg_def, see stm32f303xc.h) */
+#define CRC_REGS                        CRC
+
+/**
+ * @brief Turn on the clock of the CRC unit.
+ */
+static inline void crc_init(void) {
+    RCC_REGS->AHBENR |= RCC_AHBENR_CRCEN;
+}
+
+/**
+ * @brief Turn off the clock of the CRC unit.
+ */
+static inline void crc_deinit(void) {
+    RCC_REGS->AHBENR &= ~RCC_AHBENR_CRCEN;
+}
+
+/**
+ * @brief Returns the CRC of the given number of words.
+ * The loop is unrolled, about 2 cycles per word with flash data.
+ */
+static inline uint32 crc_calc(const uint32 * data, uint32 words) {
+    CRC_REGS->CR = CRC_CR_RESET;
+    for ( ; words >= 4; words -= 4, data += 4) {
+        CRC_REGS->DR = data[0];
+        CRC_REGS->DR = data[1];
+        CRC_REGS->DR = data[2];
+        CRC_REGS->DR = data[3];
+    }
+    while (words--)
+        CRC_REGS->DR = *data++;
+    return CRC_REGS->DR;
+}
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif
@@ -134,6 +134,20 @@ extern "C" {
 #   define STM32_SRAM_END               ((void*)0x2000C000)
 // #   define STM32_XL_DENSITY // 100pin package
 
+#elif defined(MCU_STM32F303RE)
+#   define STM32_F3_LINE                STM32_F3_LINE_303
+#   define STM32_NR_GPIO_PORTS          27
+#   define STM32_SRAM_END               ((void*)0x20010000)
+#   define STM32_HIGH_DENSITY // 64pin package
+#   define STM32_USB_PMA_2X16           1 // 1 kB USB packet memory, 2 x 16 bit per word
+
+#elif defined(MCU_STM32F303VE)
+#   define STM32_F3_LINE                STM32_F3_LINE_303
+#   define STM32_NR_GPIO_PORTS          45
+#   define STM32_SRAM_END               ((void*)0x20010000)
+#   define STM32_XL_DENSITY // 100pin package
+#   define STM32_USB_PMA_2X16           1
+
 #else
 #warning "Unsupported or unspecified STM32F3 MCU."
 #endif
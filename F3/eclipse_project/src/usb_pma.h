@@ -0,0 +1,89 @@
+/*
+ * usb_pma.h
+ *
+ * Layout of the USB packet memory (PMA) of the STM32F303, included by
+ * usb_def.h and by the host test (tools/host_test). USB_PMAADDR and
+ * STM32_USB_PMA_2X16 have to be defined before.
+ *
+ * STM32F303xB/xC: 512 bytes, seen by the CPU from 0x40006000 to 0x400063FF.
+ * The RAM is made by 4 bytes slots, wherein only the lower 16 bits are used
+ * for data (UMEM_SHIFT = 1).
+ * STM32F303xD/xE: 1 kB with 2 x 16 bit per word, the buffers and the EP table
+ * are contiguous (UMEM_SHIFT = 0).
+ *
+ * Example memory for "Hello-World", 1 x 16 bit per word
+ * 0x40006000: 48 65 00 00 6C 6C 00 00 6F 2D 00 00 57 6F 00 00 72 6C 00 00 64 ...
+ *             H  e        l  l        o  -        W  o        r  l        d ...
+ */
+
+#ifndef USB_PMA_H
+#define USB_PMA_H
+
+#include <stdint.h>
+
+#if STM32_USB_PMA_2X16
+// packet memory with 2 x 16 bit per word: accessed as 16 bit data
+#define UMEM_SHIFT					0
+#define UMEM_FAKEWIDTH				uint16_t
+#else
+// packet memory with 1 x 16 bit per 32 bit word: each 16 bit word takes
+// 32 bit of the address space
+#define UMEM_SHIFT					1
+#define UMEM_FAKEWIDTH				uint32_t
+#endif
+
+#define EP_DATA_LEN   64
+
+#define EP_RX_LEN_ID   ((1<<15)|(1<<10))
+
+#define EP_INT_MAX_LEN    8
+#define EP_INT_LEN_ID    (4<<10)
+
+//-----------------------------------------------------------------------------
+// EP table
+typedef struct epTableEntry_t
+{
+    UMEM_FAKEWIDTH txOffset;
+    UMEM_FAKEWIDTH txCount;
+    UMEM_FAKEWIDTH rxOffset;
+    UMEM_FAKEWIDTH rxCount;
+} epTableEntry_t;
+
+#define EP_TABLE_OFFSET	(6*EP_DATA_LEN) // must be after the end of 6 EP data blocks
+
+#define EP_TABLE_ADDR			(USB_PMAADDR + (EP_TABLE_OFFSET<<UMEM_SHIFT))
+
+#define EpTable   				((epTableEntry_t *) EP_TABLE_ADDR)
+
+#define EP_TABLE_SIZE			((8*4*2)<<UMEM_SHIFT) // 4 x uint16 for each of the 8 EPs
+
+//-----------------------------------------------------------------------------
+// EP buffer address offsets
+// EP0 = control
+#define EP_CTRL_TX_OFFSET   0      /* 64 Bytes ab   0 */
+#define EP_CTRL_RX_OFFSET   (EP_CTRL_TX_OFFSET + EP_DATA_LEN) // 64
+
+// EP1 = Bulk-IN+OUT for DATA
+#define EP_DATA_TX_OFFSET  (EP_CTRL_RX_OFFSET + EP_DATA_LEN) //128
+#define EP_DATA_RX_OFFSET  (EP_DATA_TX_OFFSET + EP_DATA_LEN) //192
+
+// EP2 = Bulk-IN+OUT for COMM
+#define EP_COMM_TX_OFFSET  (EP_DATA_RX_OFFSET + EP_DATA_LEN) //256
+#define EP_COMM_RX_OFFSET  (EP_COMM_TX_OFFSET + EP_INT_MAX_LEN) //264
+//-----------------------------------------------------------------------------
+// EP buffer absolute addresses
+#define USB_EP_BUF_START       (USB_PMAADDR)
+
+// the EP buffer at "offset" of the packet memory, as in the EP table
+#define PMA_ADDR(offset)		(USB_EP_BUF_START + ((offset)<<UMEM_SHIFT))
+
+#define EP_CTRL_TX_BUF_ADDRESS	PMA_ADDR(EP_CTRL_TX_OFFSET)
+#define EP_CTRL_RX_BUF_ADDRESS	PMA_ADDR(EP_CTRL_RX_OFFSET)
+
+#define EP_DATA_TX_BUF_ADDRESS	PMA_ADDR(EP_DATA_TX_OFFSET)
+#define EP_DATA_RX_BUF_ADDRESS	PMA_ADDR(EP_DATA_RX_OFFSET)
+
+#define EP_COMM_TX_BUF_ADDRESS	PMA_ADDR(EP_COMM_TX_OFFSET)
+#define EP_COMM_RX_BUF_ADDRESS	PMA_ADDR(EP_COMM_RX_OFFSET)
+
+#endif // USB_PMA_H
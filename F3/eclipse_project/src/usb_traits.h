@@ -0,0 +1,24 @@
+/*
+ * usb_traits.h
+ *
+ * STM32F3 specific part of the USB FS device driver in common/usb.c.
+ * The driver is written against the CMSIS register bit names, which are
+ * provided here by the device header. Everything is resolved by the
+ * preprocessor, there is no runtime cost.
+ */
+
+#ifndef USB_TRAITS_H
+#define USB_TRAITS_H
+
+#include "stm32f3xx.h"
+#include "stm32.h"
+
+// the USB registers are accessed as 16 bit data
+typedef uint16_t usb_reg_t;
+
+// the access scheme of the packet memory (UMEM_SHIFT, UMEM_FAKEWIDTH) is set in usb_pma.h
+
+// the page header contains the page number (offset from USER_PROGRAM) to write
+#define USB_PAGE_FROM_HEADER		1
+
+#endif // USB_TRAITS_H
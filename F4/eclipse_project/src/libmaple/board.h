@@ -0,0 +1,76 @@
+/******************************************************************************
+ * The MIT License
+ *
+ * Copyright (c) 2013 OpenMusicKontrollers.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+/**
+ * @file   board/board.h
+ * @brief  F411 "Black Pill" board header (STM32F411CE, 25 MHz HSE).
+ *
+ * See wirish/boards/maple/include/board/board.h for more information
+ * on these definitions.
+ */
+
+#ifndef _BOARD_F411xx_H_
+#define _BOARD_F411xx_H_
+
+#include "stm32.h"
+
+#define LED_BUILTIN BOARD_LED_PIN
+
+#define CYCLES_PER_MICROSECOND	(F_CPU / 1000000U)
+#define SYSTICK_RELOAD_VAL     (F_CPU/1000) - 1 /* takes a cycle to reload */
+
+enum {
+PA0, PA1, PA2, PA3, PA4, PA5, PA6, PA7, PA8, PA9, PA10, PA11, PA12, PA13, PA14, PA15,
+PB0, PB1, PB2, PB3, PB4, PB5, PB6, PB7, PB8, PB9, PB10, PB11, PB12, PB13, PB14, PB15,
+PC13 = 45, PC14, PC15, LAST_GPIO_PIN
+};
+
+// OSC_IN / OSC_OUT are PH0 / PH1, port H is not used
+
+#define USB_DM  PA11
+#define USB_DP  PA12
+
+#define BOARD_USART1_TX_PIN       PA9	/* also PB6 */
+#define BOARD_USART1_RX_PIN       PA10	/* also PB7 */
+
+#define BOARD_JTMS_SWDIO_PIN      PA13
+#define BOARD_JTCK_SWCLK_PIN      PA14
+#define BOARD_JTDI_PIN            PA15
+#define BOARD_JTDO_PIN            PB3
+#define BOARD_NJTRST_PIN          PB4
+
+#define BOARD_NR_USARTS           3
+#define BOARD_NR_GPIO_PINS        35
+#define BOARD_NR_USED_PINS         4
+
+// external crystal of the board, see system.c
+#define BOARD_HSE_MHZ             25
+
+/* redefine the following ones to match your hardware design */
+//#define BOARD_BUTTON_PIN          PA0
+#define BOARD_LED_PIN             PC13
+
+#endif
@@ -0,0 +1,178 @@
+/******************************************************************************
+ * The MIT License
+ *
+ * Copyright (c) 2010 Perry Hung.
+ * Copyright (c) 2011, 2012 LeafLabs, LLC.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+/**
+ * @file libmaple/flash.c
+ * @brief Flash management functions
+ */
+
+#include "libmaple_types.h"
+#include "flash.h"
+#include "nvic.h"
+
+/**
+ * @brief Set flash wait states
+ *
+ * Note that not all wait states are available on every MCU. See the
+ * Flash programming manual for your MCU for restrictions on the
+ * allowed value of wait_states for a given system clock (SYSCLK)
+ * frequency.
+ *
+ * @param wait_states number of wait states (one of
+ *                    FLASH_WAIT_STATE_0, FLASH_WAIT_STATE_1,
+ *                    ..., FLASH_WAIT_STATE_7).
+ */
+void flash_set_latency(uint32 wait_states)
+{
+    uint32 val = FLASH->ACR;
+
+    val &= ~FLASH_ACR_LATENCY;
+    val |= wait_states;
+
+    FLASH->ACR = val;
+}
+
+//-----------------------------------------------------------------------------
+// Reference: RM0383 chap. 3.5.
+//-----------------------------------------------------------------------------
+/*
+ * The right sequence is :
+
+ERASE:
+ - check busy flag (wait till it is reset)
+ - Set SER bit and select the sector (SNB) to be erased
+ - Set STRT bit to trigger the erase
+ - Wait till Busy flag is cleared by hardware (it takes a time)
+
+WRITE:
+ - Unlock the flash
+ - Wait on BUSY
+ - Set the PG bit and the parallelism (PSIZE)
+ - Write to destination (16-bit in a half-word aligned address)
+ - Wait on BUSY
+*/
+//-----------------------------------------------------------------------------
+// The asynchronous operations are called by the flash engine in the FLASH
+// interrupt, which runs from SRAM, see flash_engine.h
+//-----------------------------------------------------------------------------
+static __ramfunc bool Is_blank(uint32 addr, uint32 end)
+{
+	for (addr &= ~3; addr < end; addr += 4)
+		if ( *(volatile uint32 *)addr != 0xFFFFFFFF )
+			return false;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Erases the sector containing addr, unless it is blank from addr to its end.
+// The callers erase each page before writing it, in ascending order: the
+// first page of a sector erases the whole sector, the following pages are
+// still blank then and are not erased again. A skipped erase ends at once,
+// with FLASH_CR_EOPIE set its interrupt is raised by software.
+//-----------------------------------------------------------------------------
+__ramfunc void flash_erase_start(uint32 addr)
+{
+	flash_wait_for_ready();
+	FLASH->SR = FLASH_SR_EOP | FLASH_SR_ERRORS; // write 1 to clear
+	uint32 sector = flash_sector_of(addr);
+	if ( Is_blank(addr, flash_sector_start(sector+1)) )
+	{
+		if ( FLASH->CR & FLASH_CR_EOPIE )
+			nvic_irq_set_pending(NVIC_FLASH);
+		return;
+	}
+	FLASH->CR = (FLASH->CR & FLASH_CR_EOPIE) | FLASH_CR_PSIZE_X32 | FLASH_CR_SER | (sector << FLASH_CR_SNB_Pos);
+	flash_start();
+}
+
+//-----------------------------------------------------------------------------
+__ramfunc void flash_program_start(uint32 addr, uint16 value)
+{
+	flash_wait_for_ready();
+	FLASH->SR = FLASH_SR_EOP | FLASH_SR_ERRORS;
+	FLASH->CR = (FLASH->CR & FLASH_CR_EOPIE) | FLASH_CR_PSIZE_X16 | FLASH_CR_PG;
+	*(volatile uint16 *)addr = value;
+}
+
+//-----------------------------------------------------------------------------
+// x32 parallelism, addr must be word aligned. Takes as long as a half-word.
+//-----------------------------------------------------------------------------
+__ramfunc void flash_program_word_start(uint32 addr, uint32 value)
+{
+	flash_wait_for_ready();
+	FLASH->SR = FLASH_SR_EOP | FLASH_SR_ERRORS;
+	FLASH->CR = (FLASH->CR & FLASH_CR_EOPIE) | FLASH_CR_PSIZE_X32 | FLASH_CR_PG;
+	*(volatile uint32 *)addr = value;
+}
+
+//-----------------------------------------------------------------------------
+__ramfunc uint32 flash_poll(void)
+{
+	uint32 sr = FLASH->SR;
+	if ( sr & FLASH_SR_BSY )
+		return FLASH_BUSY;
+
+	FLASH->SR = sr & (FLASH_SR_EOP | FLASH_SR_ERRORS);
+	FLASH->CR &= ~(FLASH_CR_PG | FLASH_CR_SER | FLASH_CR_SNB);
+
+	uint32 err = 0;
+	if ( sr & (FLASH_SR_PGAERR | FLASH_SR_PGPERR | FLASH_SR_PGSERR) )
+		err |= FLASH_ERR_PG;
+	if ( sr & FLASH_SR_WRPERR )
+		err |= FLASH_ERR_WRP;
+	return err;
+}
+
+//-----------------------------------------------------------------------------
+__ramfunc uint32 flash_await(void)
+{
+	uint32 err;
+	while ( (err = flash_poll())==FLASH_BUSY );
+	return err;
+}
+
+//-----------------------------------------------------------------------------
+// blocking, returns the error flags
+//-----------------------------------------------------------------------------
+__ramfunc uint32 flash_erase_page(uint16_t *page)
+{
+	flash_unlock();
+	flash_erase_start((uint32)page);
+	return flash_await();
+}
+
+//-----------------------------------------------------------------------------
+__ramfunc uint32 flash_write_data(uint16_t *page, uint16_t *data, uint16_t size)
+{
+	uint32 err = 0;
+	while (size--)
+	{
+		flash_program_start((uint32)page++, *data++);
+		err |= flash_await();
+	}
+	return err;
+}
@@ -0,0 +1,206 @@
+/******************************************************************************
+ * The MIT License
+ *
+ * Copyright (c) 2010 Perry Hung.
+ * Copyright (c) 2013 OpenMusicKontrollers.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+/**
+ * @file libmaple/stm32f4/include/series/flash.h
+ * @brief STM32F4 Flash header.
+ *
+ * Provides register map, base pointer, and register bit definitions
+ * for the Flash controller on the STM32F4 line, along with
+ * series-specific configuration values.
+ *
+ * The flash is organized in sectors of 16, 64 and 128 KB, the smallest
+ * erase unit. The bootloader keeps its page view (PAGE_SIZE), see
+ * flash_erase_start().
+ */
+
+#ifndef _LIBMAPLE_STM32F4_FLASH_H_
+#define _LIBMAPLE_STM32F4_FLASH_H_
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+#include "libmaple_types.h"
+#include "stm32f4xx.h"
+
+/*
+ * Series-specific configuration values.
+ */
+
+// 3 wait states: 90 < HCLK <= 100 MHz at 2.7..3.6 V
+#define FLASH_SAFE_WAIT_STATES          FLASH_WAIT_STATE_3
+
+/* Flash memory features available via ACR */
+enum {
+    FLASH_PREFETCH   = FLASH_ACR_PRFTEN,
+    FLASH_ICACHE     = FLASH_ACR_ICEN,
+    FLASH_DCACHE     = FLASH_ACR_DCEN,
+};
+
+#define FLASH_WAIT_STATE_0              0x0
+#define FLASH_WAIT_STATE_1              0x1
+#define FLASH_WAIT_STATE_2              0x2
+#define FLASH_WAIT_STATE_3              0x3
+#define FLASH_WAIT_STATE_4              0x4
+#define FLASH_WAIT_STATE_5              0x5
+#define FLASH_WAIT_STATE_6              0x6
+#define FLASH_WAIT_STATE_7              0x7
+
+// the erase unit is a sector, larger than a page
+#define FLASH_SECTORS                   1
+#define FLASH_NR_SECTORS                8 // STM32F411CE, 512 KB
+
+// parallelism of the operations (PSIZE), 2.7..3.6 V
+#define FLASH_CR_PSIZE_X16              FLASH_CR_PSIZE_0
+#define FLASH_CR_PSIZE_X32              FLASH_CR_PSIZE_1
+// the flash engine programs aligned words with flash_program_word_start()
+#define FLASH_PROGRAM_X32               1
+
+/*
+ * Flash routines
+ */
+
+extern void flash_set_latency(uint32 wait_states);
+extern uint32 flash_erase_page(uint16_t *page);
+extern uint32 flash_write_data(uint16_t *page, uint16_t *data, uint16_t size);
+
+/*
+ * Asynchronous operations, same behaviour on all families:
+ * flash_erase_start() / flash_program_start() wait for a previous operation,
+ * start the new one and return at once. flash_poll() returns FLASH_BUSY while
+ * it runs, then ends it and returns its error flags, 0 if done without error.
+ * The flash must be unlocked, FLASH_CR_EOPIE is kept as set by the caller.
+ */
+#define FLASH_BUSY		(1<<0)
+#define FLASH_ERR_PG	(1<<1)	// PGAERR, PGPERR, PGSERR: wrong alignment, size or sequence
+#define FLASH_ERR_WRP	(1<<2)	// WRPERR: sector write protected
+
+extern void flash_erase_start(uint32 addr);
+extern void flash_program_start(uint32 addr, uint16 value);
+extern void flash_program_word_start(uint32 addr, uint32 value);
+extern uint32 flash_poll(void);
+extern uint32 flash_await(void);
+
+/**
+ * @brief Sector containing the given address
+ */
+static inline uint32 flash_sector_of(uint32 addr) {
+    uint32 offset = addr - FLASH_BASE;
+    if (offset < 0x10000)
+        return offset >> 14;		// 4 x 16 KB
+    if (offset < 0x20000)
+        return 4;					// 64 KB
+    return 4 + (offset >> 17);		// 128 KB each
+}
+
+/**
+ * @brief Start address of the given sector
+ */
+static inline uint32 flash_sector_start(uint32 sector) {
+    if (sector < 4)
+        return FLASH_BASE + (sector << 14);
+    if (sector == 4)
+        return FLASH_BASE + 0x10000;
+    return FLASH_BASE + ((sector - 4) << 17);
+}
+
+/**
+ * @brief Enable Flash memory features
+ *
+ * If the target MCU doesn't provide a feature (e.g. instruction and
+ * data caches on the STM32F1), the flag will be ignored. This allows
+ * using these flags unconditionally, with the desired effect taking
+ * place on targets that support them.
+ *
+ * @param feature_flags Bitwise OR of the following:
+ *                      FLASH_PREFETCH (turns on prefetcher),
+ *                      FLASH_ICACHE (turns on instruction cache),
+ *                      FLASH_DCACHE (turns on data cache).
+ */
+static inline void flash_enable_features(uint32 feature_flags) {
+    FLASH->ACR |= feature_flags;
+}
+
+/**
+ * @brief Deprecated. Use flash_enable_features(FLASH_PREFETCH) instead.
+ */
+static inline void flash_enable_prefetch(void) {
+    flash_enable_features(FLASH_PREFETCH);
+}
+
+// F1 name of the write protection error flag
+#define FLASH_SR_WRPRTERR		FLASH_SR_WRPERR
+
+#define FLASH_SR_ERRORS			(FLASH_SR_WRPERR | FLASH_SR_PGAERR | FLASH_SR_PGPERR | FLASH_SR_PGSERR)
+
+static inline void flash_wait_for_ready(void) {
+	while (FLASH->SR & FLASH_SR_BSY);
+}
+
+static inline int flash_locked() {
+	return (FLASH->CR & FLASH_CR_LOCK);
+}
+
+// The caches may hold flash data read before an erase or write. The data
+// cache is off while the flash is unlocked, both are flushed when locking.
+// They are turned on again if the prefetch is on, see Setup_flash().
+static inline void flash_lock() {
+	flash_wait_for_ready();
+	FLASH->CR = (FLASH->CR & ~(FLASH_CR_PG | FLASH_CR_SER | FLASH_CR_SNB)) | FLASH_CR_LOCK;
+	uint32 acr = FLASH->ACR & ~(FLASH_ACR_ICEN | FLASH_ACR_DCEN);
+	FLASH->ACR = acr;
+	FLASH->ACR = acr | FLASH_ACR_ICRST | FLASH_ACR_DCRST;
+	FLASH->ACR = acr;
+	if ( acr & FLASH_ACR_PRFTEN )
+		FLASH->ACR = acr | FLASH_ACR_ICEN | FLASH_ACR_DCEN;
+}
+
+static inline void flash_unlock(void) {
+	FLASH->ACR &= ~FLASH_ACR_DCEN;
+	// Unlock Flash with magic keys, a key written while unlocked would lock the FPEC till reset
+	if ( flash_locked() ) {
+		FLASH->KEYR = FLASH_KEY1;
+		FLASH->KEYR = FLASH_KEY2;
+	}
+}
+
+static inline void flash_start() {
+	FLASH->CR |= FLASH_CR_STRT;
+}
+
+static inline void flash_set_cr(int cr)
+{
+	FLASH->CR = cr;
+}
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
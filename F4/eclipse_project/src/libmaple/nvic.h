@@ -0,0 +1,244 @@
+/******************************************************************************
+ * The MIT License
+ *
+ * Copyright (c) 2010 Perry Hung.
+ * Copyright (c) 2013 OpenMusicKontrollers.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+/**
+ * @file libmaple/stm32f4/include/series/nvic.h
+ * @author F3-port by Hanspeter Portner <dev@open-music-kontrollers.ch>
+ * @brief STM32F4 Nested Vectored Interrupt Controller (NVIC) support.
+ */
+
+#ifndef _LIBMAPLE_STM32F4_NVIC_H_
+#define _LIBMAPLE_STM32F4_NVIC_H_
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+#include "libmaple_types.h"
+#include "stm32f4xx.h"
+#include "stm32.h"
+#include "util.h"
+
+/**
+ * @brief STM32F1 interrupt vector table interrupt numbers.
+ * @see <libmaple/scb.h>
+ */
+typedef enum nvic_irq_num {
+    NVIC_NMI            = -14,  /**< Non-maskable interrupt */
+    NVIC_HARDFAULT      = -13,  /**< Hard fault (all class of fault) */
+    NVIC_MEM_MANAGE     = -12,  /**< Memory management */
+    NVIC_BUS_FAULT      = -11,  /**< Bus fault: prefetch fault, memory
+                                     access fault. */
+    NVIC_USAGE_FAULT    = -10,  /**< Usage fault: Undefined instruction or
+                                     illegal state. */
+    NVIC_SVC            = -5,   /**< System service call via SWI insruction */
+    NVIC_DEBUG_MON      = -4,   /**< Debug monitor */
+    NVIC_PEND_SVC       = -2,   /**< Pendable request for system service */
+    NVIC_SYSTICK        = -1,   /**< System tick timer */
+
+    NVIC_WWDG           = 0,   /**< Window watchdog interrupt */
+    NVIC_PVD            = 1,   /**< PVD through EXTI line detection */
+    NVIC_TAMP_STAMP     = 2,   /**< Tamper and time stamp */
+    NVIC_RTC_WKUP       = 3,   /**< Real-time clock wakeup */
+    NVIC_FLASH          = 4,   /**< Flash */
+    NVIC_RCC            = 5,   /**< Reset and clock control */
+    NVIC_EXTI0          = 6,   /**< EXTI line 0 */
+    NVIC_EXTI1          = 7,   /**< EXTI line 1 */
+    NVIC_EXTI2          = 8,   /**< EXTI line 2 */
+    NVIC_EXTI3          = 9,   /**< EXTI line 3 */
+    NVIC_EXTI4          = 10,  /**< EXTI line 4 */
+    NVIC_DMA1_STREAM0   = 11,  /**< DMA1 stream 0 */
+    NVIC_DMA1_STREAM1   = 12,  /**< DMA1 stream 1 */
+    NVIC_DMA1_STREAM2   = 13,  /**< DMA1 stream 2 */
+    NVIC_DMA1_STREAM3   = 14,  /**< DMA1 stream 3 */
+    NVIC_DMA1_STREAM4   = 15,  /**< DMA1 stream 4 */
+    NVIC_DMA1_STREAM5   = 16,  /**< DMA1 stream 5 */
+    NVIC_DMA1_STREAM6   = 17,  /**< DMA1 stream 6 */
+    NVIC_ADC            = 18,  /**< ADC1 */
+    NVIC_EXTI_9_5       = 23,  /**< EXTI line [9:5] */
+    NVIC_TIMER1_BRK_TIMER9 = 24,  /**< Timer 1 break, Timer 9 */
+    NVIC_TIMER1_UP_TIMER10 = 25,  /**< Timer 1 update, Timer 10 */
+    NVIC_TIMER1_TRG_COM_TIMER11 = 26,  /**< Timer 1 trigger and commutation, Timer 11 */
+    NVIC_TIMER1_CC      = 27,  /**< Timer 1 capture/compare */
+    NVIC_TIMER2         = 28,  /**< Timer 2 */
+    NVIC_TIMER3         = 29,  /**< Timer 3 */
+    NVIC_TIMER4         = 30,  /**< Timer 4 */
+    NVIC_I2C1_EV        = 31,  /**< I2C1 event */
+    NVIC_I2C1_ER        = 32,  /**< I2C1 error */
+    NVIC_I2C2_EV        = 33,  /**< I2C2 event */
+    NVIC_I2C2_ER        = 34,  /**< I2C2 error */
+    NVIC_SPI1           = 35,  /**< SPI1 */
+    NVIC_SPI2           = 36,  /**< SPI2 */
+    NVIC_USART1         = 37,  /**< USART1 */
+    NVIC_USART2         = 38,  /**< USART2 */
+    NVIC_EXTI_15_10     = 40,  /**< EXTI line [15:10] */
+    NVIC_RTC_ALARM      = 41,  /**< RTC alarm through EXTI line */
+    NVIC_OTG_FS_WKUP    = 42,  /**< USB OTG FS wakeup through EXTI line */
+    NVIC_DMA1_STREAM7   = 47,  /**< DMA1 stream 7 */
+    NVIC_SDIO           = 49,  /**< SDIO */
+    NVIC_TIMER5         = 50,  /**< Timer 5 */
+    NVIC_SPI3           = 51,  /**< SPI3 */
+    NVIC_DMA2_STREAM0   = 56,  /**< DMA2 stream 0 */
+    NVIC_DMA2_STREAM1   = 57,  /**< DMA2 stream 1 */
+    NVIC_DMA2_STREAM2   = 58,  /**< DMA2 stream 2 */
+    NVIC_DMA2_STREAM3   = 59,  /**< DMA2 stream 3 */
+    NVIC_DMA2_STREAM4   = 60,  /**< DMA2 stream 4 */
+    NVIC_OTG_FS         = 67,  /**< USB OTG FS */
+    NVIC_DMA2_STREAM5   = 68,  /**< DMA2 stream 5 */
+    NVIC_DMA2_STREAM6   = 69,  /**< DMA2 stream 6 */
+    NVIC_DMA2_STREAM7   = 70,  /**< DMA2 stream 7 */
+    NVIC_USART6         = 71,  /**< USART6 */
+    NVIC_I2C3_EV        = 72,  /**< I2C3 event */
+    NVIC_I2C3_ER        = 73,  /**< I2C3 error */
+    NVIC_FPU            = 81,  /**< Floating point unit */
+    NVIC_SPI4           = 84,  /**< SPI4 */
+    NVIC_SPI5           = 85,  /**< SPI5 */
+} nvic_irq_num;
+
+
+/*
+ * Note: The series header must define enum nvic_irq_num, which gives
+ * descriptive names to the interrupts and exceptions from NMI (-14)
+ * to the largest interrupt available in the series, where the value
+ * for nonnegative enumerators corresponds to its position in the
+ * vector table.
+ *
+ * It also must define a static inline nvic_irq_disable_all(), which
+ * writes 0xFFFFFFFF to all ICE registers available in the series. (We
+ * place the include here to give the series header access to
+ * NVIC_BASE, in order to let it do so).
+ */
+
+/**
+ * @brief Set the vector table base address.
+ *
+ * For stand-alone products, the vector table base address is normally
+ * the start of Flash (0x08000000).
+ *
+ * @param address Vector table base address.
+ * @param offset Offset from address.  Some restrictions apply to the
+ *               use of nonzero offsets; see the ARM Cortex M3
+ *               Technical Reference Manual.
+ */
+static inline void nvic_set_vector_table(uint32 address, uint32 offset) {
+    SCB->VTOR = address | (offset & 0x1FFFFF80);
+}
+
+void nvic_init(uint32 address, uint32 offset);
+void nvic_irq_set_priority(nvic_irq_num irqn, uint8 priority);
+void nvic_sys_reset();
+
+/**
+ * Enables interrupts and configurable fault handlers (clear PRIMASK).
+ */
+static inline void nvic_globalirq_enable() {
+    asm volatile("cpsie i");
+}
+/**
+ * Re-enable interrupts.
+ *
+ * Call this after noInterrupts() to re-enable interrupt handling,
+ * after you have finished with a timing-critical section of code.
+ *
+ * @see noInterrupts()
+ */
+static inline void interrupts() {
+    nvic_globalirq_enable();
+}
+
+
+/**
+ * Disable interrupts and configurable fault handlers (set PRIMASK).
+ */
+static inline void nvic_globalirq_disable() {
+    asm volatile("cpsid i");
+}
+/**
+ * Disable interrupts.
+ *
+ * After calling this function, all user-programmable interrupts will
+ * be disabled.  You can call this function before a timing-critical
+ * section of code, then call interrupts() to re-enable interrupt
+ * handling.
+ *
+ * @see interrupts()
+ */
+static inline void noInterrupts() {
+    nvic_globalirq_disable();
+}
+
+
+/**
+ * @brief Enable interrupt irq_num
+ * @param irq_num Interrupt to enable
+ */
+static inline void nvic_irq_enable(nvic_irq_num irq_num) {
+    if (irq_num < 0) {
+        return;
+    }
+    NVIC->ISER[irq_num / 32] = BIT(irq_num % 32);
+}
+
+/**
+ * @brief Disable interrupt irq_num
+ * @param irq_num Interrupt to disable
+ */
+static inline void nvic_irq_disable(nvic_irq_num irq_num) {
+    if (irq_num < 0) {
+        return;
+    }
+    NVIC->ICER[irq_num / 32] = BIT(irq_num % 32);
+}
+
+/**
+ * @brief Set interrupt irq_num pending, it is taken like a hardware request
+ * @param irq_num Interrupt to set pending
+ */
+static inline void nvic_irq_set_pending(nvic_irq_num irq_num) {
+    if (irq_num < 0) {
+        return;
+    }
+    NVIC->ISPR[irq_num / 32] = BIT(irq_num % 32);
+}
+
+/**
+ * @brief Quickly disable all interrupts.
+ *
+ * Calling this function is significantly faster than calling
+ * nvic_irq_disable() in a loop.
+ */
+static inline void nvic_irq_disable_all(void) {
+    NVIC->ICER[0] = 0xFFFFFFFF;
+    NVIC->ICER[1] = 0xFFFFFFFF;
+    NVIC->ICER[2] = 0xFFFFFFFF;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,7 +1,7 @@
 /******************************************************************************
  * The MIT License
  *
- * Copyright (c) 2012 LeafLabs, LLC.
+ * Copyright (c) 2011 LeafLabs, LLC.
  *
  * Permission is hereby granted, free of charge, to any person
  * obtaining a copy of this software and associated documentation
@@ -22,24 +22,20 @@
  * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
  * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
  * SOFTWARE.
-*****************************************************************************/
+ *****************************************************************************/
 
-#ifndef _LIBMAPLE_STM32_PRIVATE_H_
-#define _LIBMAPLE_STM32_PRIVATE_H_
+/**
+ * @file libmaple/pwr.c
+ * @brief Power control (PWR) support.
+ */
 
-typedef enum stm32_mem_block_purpose {
-    STM32_BLOCK_CODE,
-    STM32_BLOCK_SRAM,
-    STM32_BLOCK_PERIPH,
-    STM32_BLOCK_FSMC_1_2,
-    STM32_BLOCK_FSMC_3_4,
-    STM32_BLOCK_FSMC_REG,
-    STM32_BLOCK_UNUSED,
-    STM32_BLOCK_CORTEX_INTERNAL,
-} stm32_mem_block_purpose;
+#include "pwr.h"
+#include "rcc.h"
 
-static inline stm32_mem_block_purpose stm32_block_purpose(void *addr) {
-    return (stm32_mem_block_purpose)((unsigned)addr >> 29);
+/**
+ * Enables the power interface clock, and resets the power device.
+ */
+void pwr_init(void) {
+    rcc_clk_enable(RCC_PWR);
+    rcc_reset_dev(RCC_PWR);
 }
-
-#endif
@@ -1,7 +1,7 @@
 /******************************************************************************
  * The MIT License
  *
- * Copyright (c) 2010 Perry Hung.
+ * Copyright (c) 2010 LeafLabs, LLC.
  *
  * Permission is hereby granted, free of charge, to any person
  * obtaining a copy of this software and associated documentation
@@ -25,21 +25,26 @@
  *****************************************************************************/
 
 /**
- *  @file libmaple/include/libmaple/libmaple.h
- *  @brief General include file for libmaple
+ * @file libmaple/include/libmaple/pwr.h
+ * @brief Power control (PWR).
  */
 
-#ifndef _LIBMAPLE_LIBMAPLE_H_
-#define _LIBMAPLE_LIBMAPLE_H_
+#ifndef _LIBMAPLE_PWR_H_
+#define _LIBMAPLE_PWR_H_
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-#include "libmaple_types.h"
-#include "stm32.h"
-#include "util.h"
-#include "delay.h"
+#include "libmaple.h"
+#include "stm32f4xx.h"
+
+
+/*
+ * Convenience functions
+ */
+
+void pwr_init(void);
 
 #ifdef __cplusplus
 }
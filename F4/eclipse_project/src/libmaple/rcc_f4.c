@@ -0,0 +1,109 @@
+/******************************************************************************
+ * The MIT License
+ *
+ * Copyright (c) 2010 Perry Hung.
+ * Copyright (c) 2011 LeafLabs, LLC.
+ * Copyright (c) 2013 OpenMusicKontrollers.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+/**
+ * @file libmaple/stm32f4/rcc.c
+ * @brief STM32F4 RCC.
+ */
+
+#include "rcc.h"
+#include "libmaple.h"
+#include "bitband.h"
+
+#include "rcc_private.h"
+
+#define APB1                            RCC_APB1
+#define APB2                            RCC_APB2
+#define AHB1                            RCC_AHB1
+#define AHB2                            RCC_AHB2
+
+/* Device descriptor table, maps rcc_clk_id onto bus and enable/reset
+ * register bit numbers. */
+const struct rcc_dev_info rcc_dev_table[] = {
+    [RCC_GPIOA]  = { .clk_domain = AHB1, .line_num = RCC_AHB1ENR_GPIOAEN_Pos },
+    [RCC_GPIOB]  = { .clk_domain = AHB1, .line_num = RCC_AHB1ENR_GPIOBEN_Pos },
+    [RCC_GPIOC]  = { .clk_domain = AHB1, .line_num = RCC_AHB1ENR_GPIOCEN_Pos },
+    [RCC_USART1] = { .clk_domain = APB2, .line_num = RCC_APB2ENR_USART1EN_Pos },
+    [RCC_CRC]    = { .clk_domain = AHB1, .line_num = RCC_AHB1ENR_CRCEN_Pos },
+    [RCC_SYSCFG] = { .clk_domain = APB2, .line_num = RCC_APB2ENR_SYSCFGEN_Pos },
+    [RCC_PWR]    = { .clk_domain = APB1, .line_num = RCC_APB1ENR_PWREN_Pos },
+    [RCC_OTGFS]  = { .clk_domain = AHB2, .line_num = RCC_AHB2ENR_OTGFSEN_Pos },
+};
+
+/* pll_cfg->data must point to a valid struct stm32f4_rcc_pll_data. */
+void rcc_configure_pll(rcc_pll_cfg *pll_cfg)
+{
+	stm32f4_rcc_pll_data *data = pll_cfg->data;
+
+    /* Check that the PLL is disabled. */
+    ASSERT_FAULT(!rcc_is_clk_on(RCC_CLK_PLL));
+
+	RCC_REGS->PLLCFGR = pll_cfg->pllsrc |
+		(data->pllm << RCC_PLLCFGR_PLLM_Pos) |
+		(data->plln << RCC_PLLCFGR_PLLN_Pos) |
+		(((data->pllp >> 1) - 1) << RCC_PLLCFGR_PLLP_Pos) |
+		(data->pllq << RCC_PLLCFGR_PLLQ_Pos);
+}
+
+static __IO uint32_t* rcc_enable_regs[] = {
+	[APB1] = &RCC_REGS->APB1ENR,
+	[APB2] = &RCC_REGS->APB2ENR,
+	[AHB1] = &RCC_REGS->AHB1ENR,
+	[AHB2] = &RCC_REGS->AHB2ENR,
+};
+void rcc_do_clk_set(rcc_clk_id id, int enable) {
+    __IO uint32_t *enable_reg = rcc_enable_regs[rcc_dev_clk(id)];
+    uint8 line_num = rcc_dev_table[id].line_num;
+    bb_peri_set_bit(enable_reg, line_num, enable);
+}
+
+
+static __IO uint32_t* rcc_reset_regs[] = {
+	[APB1] = &RCC_REGS->APB1RSTR,
+	[APB2] = &RCC_REGS->APB2RSTR,
+	[AHB1] = &RCC_REGS->AHB1RSTR,
+	[AHB2] = &RCC_REGS->AHB2RSTR,
+};
+void rcc_do_reset_dev(rcc_clk_id id) {
+	__IO uint32_t *reset_reg = rcc_reset_regs[rcc_dev_clk(id)];
+	uint8 line_num = rcc_dev_table[id].line_num;
+	bb_peri_set_bit(reset_reg, line_num, 1);
+	bb_peri_set_bit(reset_reg, line_num, 0);
+}
+
+static const uint32 rcc_masks[] = {
+	[RCC_PRESCALER_AHB] = RCC_CFGR_HPRE,
+	[RCC_PRESCALER_APB1] = RCC_CFGR_PPRE1,
+	[RCC_PRESCALER_APB2] = RCC_CFGR_PPRE2,
+};
+void rcc_do_set_prescaler(rcc_prescaler prescaler, uint32 divider) {
+    uint32 cfgr = RCC_REGS->CFGR;
+    cfgr &= ~rcc_masks[prescaler];
+    cfgr |= divider;
+    RCC_REGS->CFGR = cfgr;
+}
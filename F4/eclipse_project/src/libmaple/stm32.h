@@ -0,0 +1,80 @@
+/******************************************************************************
+ * The MIT License
+ *
+ * Copyright (c) 2010, 2011 LeafLabs, LLC.
+ * Copyright (c) 2013 OpenMusicKontrollers.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+/**
+ * @file libmaple/stm32f4/include/series/stm32.h
+ * @brief STM32F4 chip- and series-specific definitions.
+ */
+
+#ifndef _LIBMAPLE_STM32F4_H_
+#define _LIBMAPLE_STM32F4_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define STM32_MCU_SERIES                STM32_SERIES_F4
+
+/*
+ * Chip configuration
+ */
+
+#if defined(MCU_STM32F401CC)
+#   define STM32_NR_GPIO_PORTS          3
+#   define STM32_SRAM_END               ((void*)0x20010000)
+#   define STM32_MEDIUM_DENSITY // 48pin package
+#elif defined(MCU_STM32F411CE)
+#   define STM32_NR_GPIO_PORTS          3
+#   define STM32_SRAM_END               ((void*)0x20020000)
+#   define STM32_MEDIUM_DENSITY // 48pin package
+#else
+#warning "Unsupported or unspecified STM32F4 MCU."
+#endif
+
+#define STM32_HAVE_USB                  0 // no USB FS device, OTG FS only
+#define STM32_NR_INTERRUPTS             86
+
+/*
+ * Clock configuration
+ */
+
+#ifndef STM32_PCLK1
+#define STM32_PCLK1                     (F_CPU/2)
+#endif
+#ifndef STM32_PCLK2
+#define STM32_PCLK2                     F_CPU
+#endif
+
+#ifndef STM32_DELAY_US_MULT
+#define STM32_DELAY_US_MULT             (F_CPU / 3000000L)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,89 @@
+/*
+ * system.c
+ *
+ *  Created on: Apr 25, 2020
+ *      Author: stevestrong
+ */
+
+
+#include "flash.h"
+#include "rcc.h"
+#include "gpio.h"
+#include "board.h"
+
+
+// PLL of the board: 1 MHz VCO input from the HSE, 48 MHz for the OTG FS
+#ifndef BOARD_RCC_PLLN
+	#if F_CPU==96000000
+		#define BOARD_RCC_PLLN	192	// VCO 192 MHz, /2 = 96 MHz, /4 = 48 MHz
+		#define BOARD_RCC_PLLP	2
+		#define BOARD_RCC_PLLQ	4
+	#elif F_CPU==48000000
+		#define BOARD_RCC_PLLN	192	// VCO 192 MHz, /4 = 48 MHz, /4 = 48 MHz
+		#define BOARD_RCC_PLLP	4
+		#define BOARD_RCC_PLLQ	4
+	#endif
+#endif
+
+
+static stm32f4_rcc_pll_data pll_data = {.pllm=BOARD_HSE_MHZ, .plln=BOARD_RCC_PLLN, .pllp=BOARD_RCC_PLLP, .pllq=BOARD_RCC_PLLQ};
+__weak rcc_pll_cfg w_board_pll_cfg = {RCC_PLLSRC_HSE, &pll_data};
+
+void board_setup_clock_prescalers(void) {
+	rcc_set_prescaler(RCC_PRESCALER_AHB, RCC_AHB_SYSCLK_DIV_1);
+	rcc_set_prescaler(RCC_PRESCALER_APB1, RCC_APB1_HCLK_DIV_2);	// max. 50 MHz
+	rcc_set_prescaler(RCC_PRESCALER_APB2, RCC_APB2_HCLK_DIV_1);
+	rcc_clk_disable(RCC_OTGFS);
+}
+
+//-----------------------------------------------------------------------------
+void Setup_flash(void)
+{
+	// Turn on as many Flash "go faster" features as
+	// possible. flash_enable_features() just ignores any flags it
+	// can't support.
+	flash_enable_features(FLASH_PREFETCH | FLASH_ICACHE | FLASH_DCACHE);
+	// Configure the wait states, assuming we're operating at "close
+	// enough" to 3.3V.
+	flash_set_latency(FLASH_SAFE_WAIT_STATES);
+}
+//-----------------------------------------------------------------------------
+void Setup_clocks(void)
+{
+	// Turn on HSI. We'll switch to and run off of this while we're
+	// setting up the main PLL.
+	rcc_turn_on_clk(RCC_CLK_HSI);
+    while (!rcc_is_clk_ready(RCC_CLK_HSI))
+        ;
+
+	// Turn off and reset the clock subsystems we'll be using, as well
+	// as the clock security subsystem (CSS). Note that resetting CFGR
+	// to its default value of 0 implies a switch to HSI for SYSCLK.
+	RCC_REGS->CFGR = 0x00000000;
+	rcc_disable_css();
+	rcc_turn_off_clk(RCC_CLK_PLL);
+	rcc_turn_off_clk(RCC_CLK_HSE);
+	// Clear clock readiness interrupt flags and turn off clock
+	// readiness interrupts.
+	RCC_REGS->CIR = 0x00000000;
+
+	// Enable HSE, and wait until it's ready.
+	rcc_turn_on_clk(RCC_CLK_HSE);
+	while (!rcc_is_clk_ready(RCC_CLK_HSE))
+		;
+
+	// Configure AHBx, APBx, etc. prescalers and the main PLL.
+	board_setup_clock_prescalers();
+	rcc_configure_pll(&w_board_pll_cfg);
+
+	// Enable the PLL, and wait until it's ready.
+	rcc_turn_on_clk(RCC_CLK_PLL);
+	while(!rcc_is_clk_ready(RCC_CLK_PLL))
+		;
+
+	// Finally, switch to the now-ready PLL as the main clock source.
+	rcc_switch_sysclk(RCC_CLKSRC_PLL);
+
+}
+
+
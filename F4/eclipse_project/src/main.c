@@ -0,0 +1,156 @@
+/*
+ * main.c
+ *
+ * Board hooks of the STM32F4xx bootloader, see boot.h
+ *
+ *  Created on: Apr 25, 2020
+ *      Author: stevestrong
+ *
+ *      Based on http://stefanfrings.de/stm32/stm32f3.html#vcpnohal
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <usb_std.h>
+#include "stm32f4xx.h"
+
+#include "usb_def.h"
+#include "usb_func.h"
+
+#include "board.h"
+#include "systick.h"
+#include "bkp.h"
+#include "boot.h"
+#include "events.h"
+
+
+extern uint8_t _susb_ram[], _eusb_ram[]; // see LinkerScript.ld
+//-----------------------------------------------------------------------------
+// LED blinking while the bootloader is active
+#define LED_ON_MS			50
+#define LED_PERIOD_MS		250
+//-----------------------------------------------------------------------------
+// Interrupt handlers
+//-----------------------------------------------------------------------------
+__ramfunc void SysTick_Handler(void)
+{
+	systick_uptime_millis++; // __exc_systick() is in flash, the user callback is not used
+}
+//-----------------------------------------------------------------------------
+void IO_init()
+{
+    gpio_init_all(); // A, B and C
+
+    // PC13 = Output (LED on Black-Pill board)
+	gpio_set_mode(LED_BUILTIN, GPIO_OUTPUT);
+}
+//-----------------------------------------------------------------------------
+void IO_deinit()
+{
+    gpio_deinit_all(); // A, B and C
+}
+//-----------------------------------------------------------------------------
+// the time D+ is held low to signal a disconnect (USB 2.0 TDDIS: 2.5 us max.)
+#define USB_DISCONNECT_US	10
+//-----------------------------------------------------------------------------
+// the reset of the OTG core turns off the transceiver and the pull-up on D+
+//-----------------------------------------------------------------------------
+void USB_power_off(void)
+{
+	nvic_irq_disable(NVIC_OTG_FS);
+	rcc_reset_dev(RCC_OTGFS);
+}
+//-----------------------------------------------------------------------------
+void Setup_sys()
+{
+	crt_page = 0;
+	num_pages = 0;
+}
+
+//-----------------------------------------------------------------------------
+// USB-Setup
+//-----------------------------------------------------------------------------
+void UsbSetup(void)
+{
+	trace("setup\n");
+
+	// the variables of the USB stack are not cleared by the startup code
+	memset(_susb_ram, 0, _eusb_ram - _susb_ram);
+
+    // Enable USB
+	rcc_clk_enable(RCC_OTGFS);
+
+	Setup_sys();
+	CMD.configuration = 0;
+
+    Class_Start();            // setup LineCoding-Block with default values
+
+	USB_power_off();
+
+	// device mode, FIFOs and interrupts, see usb_otg.c
+	USB_core_init();
+	EnableUsbIRQ();
+
+	// turn on the pull-up on D+
+	USB_connect();
+}
+//-----------------------------------------------------------------------------
+void GpioToggle(void)
+{
+	//Reset the USB interface
+	gpio_set_mode(USB_DP, GPIO_OUTPUT);
+	gpio_write_pin(USB_DP, 0);
+	// Only small delay is needed for re-enumeration
+	dwt_delay_us(USB_DISCONNECT_US);
+	// USB_DP and USB_DM have to be set to output, and AF = GPIO_AF_USB
+	gpio_set_mode(USB_DM, GPIO_AF_OUTPUT);
+	gpio_set_af(USB_DM, GPIO_AF_USB);
+	gpio_set_mode(USB_DP, GPIO_AF_OUTPUT);
+	gpio_set_af(USB_DP, GPIO_AF_USB);
+}
+
+//-----------------------------------------------------------------------------
+uint16_t Get_and_clear_magic_word(void)
+{
+	bkp_init();
+	uint16_t value = bkp_read(16);
+	if (value)
+	{
+		// Enable write access to the backup registers and the RTC.
+		bkp_enable_writes();
+		bkp_write(16, 0);
+		bkp_disable_writes();
+	}
+	bkp_deinit();
+	return value;
+}
+
+//-----------------------------------------------------------------------------
+void Main_init(void)
+{
+    GpioToggle();
+
+    UsbSetup();
+
+	systick_init();
+}
+//-----------------------------------------------------------------------------
+void Main_loop()
+{
+	Event_wait(); // woken up by the USB and SysTick interrupts
+
+	// LED blinking
+	if ( (systick_uptime_millis % LED_PERIOD_MS) < LED_ON_MS )
+		LED_ON;
+	else
+		LED_OFF;
+}
+
+//-----------------------------------------------------------------------------
+// reset cause and clock configuration for the handoff block, see boot_handoff.h
+//-----------------------------------------------------------------------------
+void Handoff_regs(boot_handoff_t * h)
+{
+	h->reset_cause = RCC_REGS->CSR;
+	h->rcc_cfgr = RCC_REGS->CFGR;
+}
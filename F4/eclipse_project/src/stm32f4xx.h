@@ -0,0 +1,503 @@
+/**
+  ******************************************************************************
+  * @file    stm32f4xx.h
+  * @brief   CMSIS STM32F411xE Peripheral Access Layer Header File.
+  *
+  *          Reduced to the peripherals used by the bootloader: RCC, FLASH,
+  *          GPIO, PWR, CRC and USB OTG FS. The register and bit names follow
+  *          the CMSIS device header of ST, the register map types are named
+  *          xxx_reg_def like in stm32f303xc.h of the F3 project.
+  *
+  ******************************************************************************
+  */
+
+#ifndef __STM32F4xx_H
+#define __STM32F4xx_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif /* __cplusplus */
+
+#if !defined (STM32F4)
+#define STM32F4
+#endif /* STM32F4 */
+
+#if !defined (STM32F411xE)
+#define STM32F411xE
+#endif
+
+/*
+ * Configuration of the Cortex-M4 processor and core peripherals
+ */
+#define __CM4_REV                 0x0001U  /*!< Core revision r0p1                            */
+#define __MPU_PRESENT             1U       /*!< STM32F4XX provides an MPU                     */
+#define __NVIC_PRIO_BITS          4U       /*!< STM32F4XX uses 4 Bits for the Priority Levels */
+#define __Vendor_SysTickConfig    0U       /*!< Set to 1 if different SysTick Config is used  */
+#define __FPU_PRESENT             1U       /*!< FPU present                                   */
+
+/*
+ * STM32F411xE Interrupt Number Definition
+ */
+typedef enum
+{
+  NonMaskableInt_IRQn         = -14,    /*!< 2 Non Maskable Interrupt                                          */
+  HardFault_IRQn              = -13,    /*!< 3 Cortex-M4 Hard Fault Interrupt                                  */
+  MemoryManagement_IRQn       = -12,    /*!< 4 Cortex-M4 Memory Management Interrupt                           */
+  BusFault_IRQn               = -11,    /*!< 5 Cortex-M4 Bus Fault Interrupt                                   */
+  UsageFault_IRQn             = -10,    /*!< 6 Cortex-M4 Usage Fault Interrupt                                 */
+  SVCall_IRQn                 = -5,     /*!< 11 Cortex-M4 SV Call Interrupt                                    */
+  DebugMonitor_IRQn           = -4,     /*!< 12 Cortex-M4 Debug Monitor Interrupt                              */
+  PendSV_IRQn                 = -2,     /*!< 14 Cortex-M4 Pend SV Interrupt                                    */
+  SysTick_IRQn                = -1,     /*!< 15 Cortex-M4 System Tick Interrupt                                */
+  WWDG_IRQn                   = 0,      /*!< Window WatchDog Interrupt                                         */
+  PVD_IRQn                    = 1,      /*!< PVD through EXTI Line detection Interrupt                         */
+  TAMP_STAMP_IRQn             = 2,      /*!< Tamper and TimeStamp interrupts through the EXTI line             */
+  RTC_WKUP_IRQn               = 3,      /*!< RTC Wakeup interrupt through the EXTI line                        */
+  FLASH_IRQn                  = 4,      /*!< FLASH global Interrupt                                            */
+  RCC_IRQn                    = 5,      /*!< RCC global Interrupt                                              */
+  EXTI0_IRQn                  = 6,      /*!< EXTI Line0 Interrupt                                              */
+  EXTI1_IRQn                  = 7,      /*!< EXTI Line1 Interrupt                                              */
+  EXTI2_IRQn                  = 8,      /*!< EXTI Line2 Interrupt                                              */
+  EXTI3_IRQn                  = 9,      /*!< EXTI Line3 Interrupt                                              */
+  EXTI4_IRQn                  = 10,     /*!< EXTI Line4 Interrupt                                              */
+  DMA1_Stream0_IRQn           = 11,     /*!< DMA1 Stream 0 global Interrupt                                    */
+  DMA1_Stream1_IRQn           = 12,     /*!< DMA1 Stream 1 global Interrupt                                    */
+  DMA1_Stream2_IRQn           = 13,     /*!< DMA1 Stream 2 global Interrupt                                    */
+  DMA1_Stream3_IRQn           = 14,     /*!< DMA1 Stream 3 global Interrupt                                    */
+  DMA1_Stream4_IRQn           = 15,     /*!< DMA1 Stream 4 global Interrupt                                    */
+  DMA1_Stream5_IRQn           = 16,     /*!< DMA1 Stream 5 global Interrupt                                    */
+  DMA1_Stream6_IRQn           = 17,     /*!< DMA1 Stream 6 global Interrupt                                    */
+  ADC_IRQn                    = 18,     /*!< ADC1 global Interrupt                                             */
+  EXTI9_5_IRQn                = 23,     /*!< External Line[9:5] Interrupts                                     */
+  TIM1_BRK_TIM9_IRQn          = 24,     /*!< TIM1 Break interrupt and TIM9 global interrupt                    */
+  TIM1_UP_TIM10_IRQn          = 25,     /*!< TIM1 Update Interrupt and TIM10 global interrupt                  */
+  TIM1_TRG_COM_TIM11_IRQn     = 26,     /*!< TIM1 Trigger and Commutation Interrupt and TIM11 global interrupt */
+  TIM1_CC_IRQn                = 27,     /*!< TIM1 Capture Compare Interrupt                                    */
+  TIM2_IRQn                   = 28,     /*!< TIM2 global Interrupt                                             */
+  TIM3_IRQn                   = 29,     /*!< TIM3 global Interrupt                                             */
+  TIM4_IRQn                   = 30,     /*!< TIM4 global Interrupt                                             */
+  I2C1_EV_IRQn                = 31,     /*!< I2C1 Event Interrupt                                              */
+  I2C1_ER_IRQn                = 32,     /*!< I2C1 Error Interrupt                                              */
+  I2C2_EV_IRQn                = 33,     /*!< I2C2 Event Interrupt                                              */
+  I2C2_ER_IRQn                = 34,     /*!< I2C2 Error Interrupt                                              */
+  SPI1_IRQn                   = 35,     /*!< SPI1 global Interrupt                                             */
+  SPI2_IRQn                   = 36,     /*!< SPI2 global Interrupt                                             */
+  USART1_IRQn                 = 37,     /*!< USART1 global Interrupt                                           */
+  USART2_IRQn                 = 38,     /*!< USART2 global Interrupt                                           */
+  EXTI15_10_IRQn              = 40,     /*!< External Line[15:10] Interrupts                                   */
+  RTC_Alarm_IRQn              = 41,     /*!< RTC Alarm (A and B) through EXTI Line Interrupt                   */
+  OTG_FS_WKUP_IRQn            = 42,     /*!< USB OTG FS Wakeup through EXTI line interrupt                     */
+  DMA1_Stream7_IRQn           = 47,     /*!< DMA1 Stream7 Interrupt                                            */
+  SDIO_IRQn                   = 49,     /*!< SDIO global Interrupt                                             */
+  TIM5_IRQn                   = 50,     /*!< TIM5 global Interrupt                                             */
+  SPI3_IRQn                   = 51,     /*!< SPI3 global Interrupt                                             */
+  DMA2_Stream0_IRQn           = 56,     /*!< DMA2 Stream 0 global Interrupt                                    */
+  DMA2_Stream1_IRQn           = 57,     /*!< DMA2 Stream 1 global Interrupt                                    */
+  DMA2_Stream2_IRQn           = 58,     /*!< DMA2 Stream 2 global Interrupt                                    */
+  DMA2_Stream3_IRQn           = 59,     /*!< DMA2 Stream 3 global Interrupt                                    */
+  DMA2_Stream4_IRQn           = 60,     /*!< DMA2 Stream 4 global Interrupt                                    */
+  OTG_FS_IRQn                 = 67,     /*!< USB OTG FS global Interrupt                                       */
+  DMA2_Stream5_IRQn           = 68,     /*!< DMA2 Stream 5 global interrupt                                    */
+  DMA2_Stream6_IRQn           = 69,     /*!< DMA2 Stream 6 global interrupt                                    */
+  DMA2_Stream7_IRQn           = 70,     /*!< DMA2 Stream 7 global interrupt                                    */
+  USART6_IRQn                 = 71,     /*!< USART6 global interrupt                                           */
+  I2C3_EV_IRQn                = 72,     /*!< I2C3 event interrupt                                              */
+  I2C3_ER_IRQn                = 73,     /*!< I2C3 error interrupt                                              */
+  FPU_IRQn                    = 81,     /*!< FPU global interrupt                                              */
+  SPI4_IRQn                   = 84,     /*!< SPI4 global Interrupt                                             */
+  SPI5_IRQn                   = 85      /*!< SPI5 global Interrupt                                             */
+} IRQn_Type;
+
+#include "core_cm4.h"             /* Cortex-M4 processor and core peripherals */
+#include <stdint.h>
+
+/*
+ * Peripheral registers structures
+ */
+
+/**
+  * @brief CRC calculation unit
+  */
+typedef struct
+{
+  __IO uint32_t DR;          /*!< CRC Data register,             Address offset: 0x00 */
+  __IO uint8_t  IDR;         /*!< CRC Independent data register, Address offset: 0x04 */
+  uint8_t       RESERVED0;   /*!< Reserved, 0x05                                      */
+  uint16_t      RESERVED1;   /*!< Reserved, 0x06                                      */
+  __IO uint32_t CR;          /*!< CRC Control register,          Address offset: 0x08 */
+} CRC_reg_def;
+
+/**
+  * @brief FLASH Registers
+  */
+typedef struct
+{
+  __IO uint32_t ACR;      /*!< FLASH access control register,   Address offset: 0x00 */
+  __IO uint32_t KEYR;     /*!< FLASH key register,              Address offset: 0x04 */
+  __IO uint32_t OPTKEYR;  /*!< FLASH option key register,       Address offset: 0x08 */
+  __IO uint32_t SR;       /*!< FLASH status register,           Address offset: 0x0C */
+  __IO uint32_t CR;       /*!< FLASH control register,          Address offset: 0x10 */
+  __IO uint32_t OPTCR;    /*!< FLASH option control register ,  Address offset: 0x14 */
+} FLASH_reg_def;
+
+/**
+  * @brief General Purpose I/O
+  */
+typedef struct
+{
+  __IO uint32_t MODER;    /*!< GPIO port mode register,               Address offset: 0x00      */
+  __IO uint32_t OTYPER;   /*!< GPIO port output type register,        Address offset: 0x04      */
+  __IO uint32_t OSPEEDR;  /*!< GPIO port output speed register,       Address offset: 0x08      */
+  __IO uint32_t PUPDR;    /*!< GPIO port pull-up/pull-down register,  Address offset: 0x0C      */
+  __IO uint32_t IDR;      /*!< GPIO port input data register,         Address offset: 0x10      */
+  __IO uint32_t ODR;      /*!< GPIO port output data register,        Address offset: 0x14      */
+  __IO uint32_t BSRR;     /*!< GPIO port bit set/reset register,      Address offset: 0x18      */
+  __IO uint32_t LCKR;     /*!< GPIO port configuration lock register, Address offset: 0x1C      */
+  __IO uint32_t AFR[2];   /*!< GPIO alternate function registers,     Address offset: 0x20-0x24 */
+} gpio_reg_def;
+
+/**
+  * @brief Power Control
+  */
+typedef struct
+{
+  __IO uint32_t CR;   /*!< PWR power control register,        Address offset: 0x00 */
+  __IO uint32_t CSR;  /*!< PWR power control/status register, Address offset: 0x04 */
+} PWR_reg_def;
+
+/**
+  * @brief Reset and Clock Control
+  */
+typedef struct
+{
+  __IO uint32_t CR;            /*!< RCC clock control register,                                  Address offset: 0x00 */
+  __IO uint32_t PLLCFGR;       /*!< RCC PLL configuration register,                              Address offset: 0x04 */
+  __IO uint32_t CFGR;          /*!< RCC clock configuration register,                            Address offset: 0x08 */
+  __IO uint32_t CIR;           /*!< RCC clock interrupt register,                                Address offset: 0x0C */
+  __IO uint32_t AHB1RSTR;      /*!< RCC AHB1 peripheral reset register,                          Address offset: 0x10 */
+  __IO uint32_t AHB2RSTR;      /*!< RCC AHB2 peripheral reset register,                          Address offset: 0x14 */
+  uint32_t      RESERVED0[2];  /*!< Reserved, 0x18-0x1C                                                               */
+  __IO uint32_t APB1RSTR;      /*!< RCC APB1 peripheral reset register,                          Address offset: 0x20 */
+  __IO uint32_t APB2RSTR;      /*!< RCC APB2 peripheral reset register,                          Address offset: 0x24 */
+  uint32_t      RESERVED1[2];  /*!< Reserved, 0x28-0x2C                                                               */
+  __IO uint32_t AHB1ENR;       /*!< RCC AHB1 peripheral clock register,                          Address offset: 0x30 */
+  __IO uint32_t AHB2ENR;       /*!< RCC AHB2 peripheral clock register,                          Address offset: 0x34 */
+  uint32_t      RESERVED2[2];  /*!< Reserved, 0x38-0x3C                                                               */
+  __IO uint32_t APB1ENR;       /*!< RCC APB1 peripheral clock enable register,                   Address offset: 0x40 */
+  __IO uint32_t APB2ENR;       /*!< RCC APB2 peripheral clock enable register,                   Address offset: 0x44 */
+  uint32_t      RESERVED3[2];  /*!< Reserved, 0x48-0x4C                                                               */
+  __IO uint32_t AHB1LPENR;     /*!< RCC AHB1 peripheral clock enable in low power mode register, Address offset: 0x50 */
+  __IO uint32_t AHB2LPENR;     /*!< RCC AHB2 peripheral clock enable in low power mode register, Address offset: 0x54 */
+  uint32_t      RESERVED4[2];  /*!< Reserved, 0x58-0x5C                                                               */
+  __IO uint32_t APB1LPENR;     /*!< RCC APB1 peripheral clock enable in low power mode register, Address offset: 0x60 */
+  __IO uint32_t APB2LPENR;     /*!< RCC APB2 peripheral clock enable in low power mode register, Address offset: 0x64 */
+  uint32_t      RESERVED5[2];  /*!< Reserved, 0x68-0x6C                                                               */
+  __IO uint32_t BDCR;          /*!< RCC Backup domain control register,                          Address offset: 0x70 */
+  __IO uint32_t CSR;           /*!< RCC clock control & status register,                         Address offset: 0x74 */
+  uint32_t      RESERVED6[2];  /*!< Reserved, 0x78-0x7C                                                               */
+  __IO uint32_t SSCGR;         /*!< RCC spread spectrum clock generation register,               Address offset: 0x80 */
+  __IO uint32_t PLLI2SCFGR;    /*!< RCC PLLI2S configuration register,                           Address offset: 0x84 */
+  uint32_t      RESERVED7[1];  /*!< Reserved, 0x88                                                                    */
+  __IO uint32_t DCKCFGR;       /*!< RCC Dedicated Clocks configuration register,                 Address offset: 0x8C */
+} rcc_reg_def;
+
+/**
+  * @brief USB_OTG_Core_Registers
+  */
+typedef struct
+{
+  __IO uint32_t GOTGCTL;              /*!< USB_OTG Control and Status Register          000h */
+  __IO uint32_t GOTGINT;              /*!< USB_OTG Interrupt Register                   004h */
+  __IO uint32_t GAHBCFG;              /*!< Core AHB Configuration Register              008h */
+  __IO uint32_t GUSBCFG;              /*!< Core USB Configuration Register              00Ch */
+  __IO uint32_t GRSTCTL;              /*!< Core Reset Register                          010h */
+  __IO uint32_t GINTSTS;              /*!< Core Interrupt Register                      014h */
+  __IO uint32_t GINTMSK;              /*!< Core Interrupt Mask Register                 018h */
+  __IO uint32_t GRXSTSR;              /*!< Receive Sts Q Read Register                  01Ch */
+  __IO uint32_t GRXSTSP;              /*!< Receive Sts Q Read & POP Register            020h */
+  __IO uint32_t GRXFSIZ;              /*!< Receive FIFO Size Register                   024h */
+  __IO uint32_t DIEPTXF0_HNPTXFSIZ;   /*!< EP0 / Non Periodic Tx FIFO Size Register     028h */
+  __IO uint32_t HNPTXSTS;             /*!< Non Periodic Tx FIFO/Queue Sts reg           02Ch */
+  uint32_t Reserved30[2];             /*!< Reserved                                     030h */
+  __IO uint32_t GCCFG;                /*!< General Purpose IO Register                  038h */
+  __IO uint32_t CID;                  /*!< User ID Register                             03Ch */
+  uint32_t  Reserved40[48];           /*!< Reserved                                0x40-0xFF */
+  __IO uint32_t HPTXFSIZ;             /*!< Host Periodic Tx FIFO Size Reg               100h */
+  __IO uint32_t DIEPTXF[0x0F];        /*!< dev Periodic Transmit FIFO                        */
+} USB_OTG_reg_def;
+
+/**
+  * @brief USB_OTG_device_Registers
+  */
+typedef struct
+{
+  __IO uint32_t DCFG;            /*!< dev Configuration Register   800h */
+  __IO uint32_t DCTL;            /*!< dev Control Register         804h */
+  __IO uint32_t DSTS;            /*!< dev Status Register (RO)     808h */
+  uint32_t Reserved0C;           /*!< Reserved                     80Ch */
+  __IO uint32_t DIEPMSK;         /*!< dev IN Endpoint Mask         810h */
+  __IO uint32_t DOEPMSK;         /*!< dev OUT Endpoint Mask        814h */
+  __IO uint32_t DAINT;           /*!< dev All Endpoints Itr Reg    818h */
+  __IO uint32_t DAINTMSK;        /*!< dev All Endpoints Itr Mask   81Ch */
+  uint32_t  Reserved20;          /*!< Reserved                     820h */
+  uint32_t Reserved9;            /*!< Reserved                     824h */
+  __IO uint32_t DVBUSDIS;        /*!< dev VBUS discharge Register  828h */
+  __IO uint32_t DVBUSPULSE;      /*!< dev VBUS Pulse Register      82Ch */
+  __IO uint32_t DTHRCTL;         /*!< dev threshold                830h */
+  __IO uint32_t DIEPEMPMSK;      /*!< dev empty msk                834h */
+} USB_OTG_Device_reg_def;
+
+/**
+  * @brief USB_OTG_IN_Endpoint-Specific_Register
+  */
+typedef struct
+{
+  __IO uint32_t DIEPCTL;           /*!< dev IN Endpoint Control Reg    900h + (ep_num * 20h) + 00h */
+  uint32_t Reserved04;             /*!< Reserved                       900h + (ep_num * 20h) + 04h */
+  __IO uint32_t DIEPINT;           /*!< dev IN Endpoint Itr Reg        900h + (ep_num * 20h) + 08h */
+  uint32_t Reserved0C;             /*!< Reserved                       900h + (ep_num * 20h) + 0Ch */
+  __IO uint32_t DIEPTSIZ;          /*!< IN Endpoint Txfer Size         900h + (ep_num * 20h) + 10h */
+  __IO uint32_t DIEPDMA;           /*!< IN Endpoint DMA Address Reg    900h + (ep_num * 20h) + 14h */
+  __IO uint32_t DTXFSTS;           /*!< IN Endpoint Tx FIFO Status Reg 900h + (ep_num * 20h) + 18h */
+  uint32_t Reserved18;             /*!< Reserved  900h+(ep_num*20h)+1Ch-900h+ (ep_num * 20h) + 1Ch */
+} USB_OTG_INEndpoint_reg_def;
+
+/**
+  * @brief USB_OTG_OUT_Endpoint-Specific_Registers
+  */
+typedef struct
+{
+  __IO uint32_t DOEPCTL;       /*!< dev OUT Endpoint Control Reg           B00h + (ep_num * 20h) + 00h */
+  uint32_t Reserved04;         /*!< Reserved                               B00h + (ep_num * 20h) + 04h */
+  __IO uint32_t DOEPINT;       /*!< dev OUT Endpoint Itr Reg               B00h + (ep_num * 20h) + 08h */
+  uint32_t Reserved0C;         /*!< Reserved                               B00h + (ep_num * 20h) + 0Ch */
+  __IO uint32_t DOEPTSIZ;      /*!< dev OUT Endpoint Txfer Size            B00h + (ep_num * 20h) + 10h */
+  __IO uint32_t DOEPDMA;       /*!< dev OUT Endpoint DMA Address           B00h + (ep_num * 20h) + 14h */
+  uint32_t Reserved18[2];      /*!< Reserved B00h + (ep_num * 20h) + 18h - B00h + (ep_num * 20h) + 1Ch */
+} USB_OTG_OUTEndpoint_reg_def;
+
+/*
+ * Peripheral memory map
+ */
+#define FLASH_BASE            0x08000000U /*!< FLASH(up to 1 MB) base address in the alias region */
+#define SRAM_BASE             0x20000000U /*!< SRAM(128 KB) base address in the alias region       */
+#define PERIPH_BASE           0x40000000U /*!< Peripheral base address in the alias region         */
+#define SRAM_BB_BASE          0x22000000U /*!< SRAM base address in the bit-band region            */
+#define PERIPH_BB_BASE        0x42000000U /*!< Peripheral base address in the bit-band region      */
+
+#define APB1PERIPH_BASE       PERIPH_BASE
+#define APB2PERIPH_BASE       (PERIPH_BASE + 0x00010000U)
+#define AHB1PERIPH_BASE       (PERIPH_BASE + 0x00020000U)
+#define AHB2PERIPH_BASE       (PERIPH_BASE + 0x10000000U)
+
+#define RTC_BASE              (APB1PERIPH_BASE + 0x2800U)
+#define PWR_BASE              (APB1PERIPH_BASE + 0x7000U)
+#define GPIOA_BASE            (AHB1PERIPH_BASE + 0x0000U)
+#define GPIOB_BASE            (AHB1PERIPH_BASE + 0x0400U)
+#define GPIOC_BASE            (AHB1PERIPH_BASE + 0x0800U)
+#define CRC_BASE              (AHB1PERIPH_BASE + 0x3000U)
+#define RCC_BASE              (AHB1PERIPH_BASE + 0x3800U)
+#define FLASH_R_BASE          (AHB1PERIPH_BASE + 0x3C00U)
+#define USB_OTG_FS_PERIPH_BASE 0x50000000U
+
+#define USB_OTG_GLOBAL_BASE            0x000U
+#define USB_OTG_DEVICE_BASE            0x800U
+#define USB_OTG_IN_ENDPOINT_BASE       0x900U
+#define USB_OTG_OUT_ENDPOINT_BASE      0xB00U
+#define USB_OTG_EP_REG_SIZE            0x20U
+#define USB_OTG_PCGCCTL_BASE           0xE00U
+#define USB_OTG_FIFO_BASE              0x1000U
+#define USB_OTG_FIFO_SIZE              0x1000U
+
+/*
+ * Peripheral declaration
+ */
+#define PWR                 ((PWR_reg_def *) PWR_BASE)
+#define GPIOA_REGS          ((gpio_reg_def *) GPIOA_BASE)
+#define GPIOB_REGS          ((gpio_reg_def *) GPIOB_BASE)
+#define GPIOC_REGS          ((gpio_reg_def *) GPIOC_BASE)
+#define CRC                 ((CRC_reg_def *) CRC_BASE)
+#define RCC_REGS            ((rcc_reg_def *) RCC_BASE)
+#define FLASH               ((FLASH_reg_def *) FLASH_R_BASE)
+#define USB_OTG_FS          ((USB_OTG_reg_def *) USB_OTG_FS_PERIPH_BASE)
+
+/*
+ * Peripheral registers bits definition
+ */
+
+/********************  Bit definition for CRC_CR register  ********************/
+#define CRC_CR_RESET                        (0x1U << 0)
+
+/******************  Bits definition for FLASH_ACR register  ******************/
+#define FLASH_ACR_LATENCY_Pos               (0U)
+#define FLASH_ACR_LATENCY                   (0xFU << FLASH_ACR_LATENCY_Pos)
+#define FLASH_ACR_PRFTEN                    (0x1U << 8)
+#define FLASH_ACR_ICEN                      (0x1U << 9)
+#define FLASH_ACR_DCEN                      (0x1U << 10)
+#define FLASH_ACR_ICRST                     (0x1U << 11)
+#define FLASH_ACR_DCRST                     (0x1U << 12)
+
+/*******************  Bits definition for FLASH_SR register  ******************/
+#define FLASH_SR_EOP                        (0x1U << 0)
+#define FLASH_SR_SOP                        (0x1U << 1)
+#define FLASH_SR_WRPERR                     (0x1U << 4)
+#define FLASH_SR_PGAERR                     (0x1U << 5)
+#define FLASH_SR_PGPERR                     (0x1U << 6)
+#define FLASH_SR_PGSERR                     (0x1U << 7)
+#define FLASH_SR_RDERR                      (0x1U << 8)
+#define FLASH_SR_BSY                        (0x1U << 16)
+
+/*******************  Bits definition for FLASH_CR register  ******************/
+#define FLASH_CR_PG                         (0x1U << 0)
+#define FLASH_CR_SER                        (0x1U << 1)
+#define FLASH_CR_MER                        (0x1U << 2)
+#define FLASH_CR_SNB_Pos                    (3U)
+#define FLASH_CR_SNB                        (0x1FU << FLASH_CR_SNB_Pos)
+#define FLASH_CR_PSIZE_Pos                  (8U)
+#define FLASH_CR_PSIZE                      (0x3U << FLASH_CR_PSIZE_Pos)
+#define FLASH_CR_PSIZE_0                    (0x1U << FLASH_CR_PSIZE_Pos)
+#define FLASH_CR_PSIZE_1                    (0x2U << FLASH_CR_PSIZE_Pos)
+#define FLASH_CR_STRT                       (0x1U << 16)
+#define FLASH_CR_EOPIE                      (0x1U << 24)
+#define FLASH_CR_ERRIE                      (0x1U << 25)
+#define FLASH_CR_LOCK                       (0x1U << 31)
+
+/*******************  Bits definition for FLASH_KEYR register  ****************/
+#define FLASH_KEY1                          0x45670123U
+#define FLASH_KEY2                          0xCDEF89ABU
+
+/********************  Bit definition for PWR_CR register  ********************/
+#define PWR_CR_DBP                          (0x1U << 8)
+
+/********************  Bit definition for RCC_CR register  ********************/
+#define RCC_CR_HSION_Pos                    (0U)
+#define RCC_CR_HSION                        (0x1U << RCC_CR_HSION_Pos)
+#define RCC_CR_HSIRDY                       (0x1U << 1)
+#define RCC_CR_HSEON_Pos                    (16U)
+#define RCC_CR_HSEON                        (0x1U << RCC_CR_HSEON_Pos)
+#define RCC_CR_HSERDY                       (0x1U << 17)
+#define RCC_CR_HSEBYP                       (0x1U << 18)
+#define RCC_CR_CSSON                        (0x1U << 19)
+#define RCC_CR_PLLON_Pos                    (24U)
+#define RCC_CR_PLLON                        (0x1U << RCC_CR_PLLON_Pos)
+#define RCC_CR_PLLRDY                       (0x1U << 25)
+
+/********************  Bit definition for RCC_PLLCFGR register  ***************/
+#define RCC_PLLCFGR_PLLM_Pos                (0U)
+#define RCC_PLLCFGR_PLLM                    (0x3FU << RCC_PLLCFGR_PLLM_Pos)
+#define RCC_PLLCFGR_PLLN_Pos                (6U)
+#define RCC_PLLCFGR_PLLN                    (0x1FFU << RCC_PLLCFGR_PLLN_Pos)
+#define RCC_PLLCFGR_PLLP_Pos                (16U)
+#define RCC_PLLCFGR_PLLP                    (0x3U << RCC_PLLCFGR_PLLP_Pos)
+#define RCC_PLLCFGR_PLLSRC_Pos              (22U)
+#define RCC_PLLCFGR_PLLSRC                  (0x1U << RCC_PLLCFGR_PLLSRC_Pos)
+#define RCC_PLLCFGR_PLLQ_Pos                (24U)
+#define RCC_PLLCFGR_PLLQ                    (0xFU << RCC_PLLCFGR_PLLQ_Pos)
+
+/********************  Bit definition for RCC_CFGR register  ******************/
+#define RCC_CFGR_SW                         (0x3U << 0)
+#define RCC_CFGR_SWS                        (0x3U << 2)
+#define RCC_CFGR_HPRE                       (0xFU << 4)
+#define RCC_CFGR_HPRE_DIV1                  (0x0U << 4)
+#define RCC_CFGR_HPRE_DIV2                  (0x8U << 4)
+#define RCC_CFGR_HPRE_DIV4                  (0x9U << 4)
+#define RCC_CFGR_HPRE_DIV8                  (0xAU << 4)
+#define RCC_CFGR_HPRE_DIV16                 (0xBU << 4)
+#define RCC_CFGR_HPRE_DIV64                 (0xCU << 4)
+#define RCC_CFGR_HPRE_DIV128                (0xDU << 4)
+#define RCC_CFGR_HPRE_DIV256                (0xEU << 4)
+#define RCC_CFGR_HPRE_DIV512                (0xFU << 4)
+#define RCC_CFGR_PPRE1                      (0x7U << 10)
+#define RCC_CFGR_PPRE1_DIV1                 (0x0U << 10)
+#define RCC_CFGR_PPRE1_DIV2                 (0x4U << 10)
+#define RCC_CFGR_PPRE1_DIV4                 (0x5U << 10)
+#define RCC_CFGR_PPRE1_DIV8                 (0x6U << 10)
+#define RCC_CFGR_PPRE1_DIV16                (0x7U << 10)
+#define RCC_CFGR_PPRE2                      (0x7U << 13)
+#define RCC_CFGR_PPRE2_DIV1                 (0x0U << 13)
+#define RCC_CFGR_PPRE2_DIV2                 (0x4U << 13)
+#define RCC_CFGR_PPRE2_DIV4                 (0x5U << 13)
+#define RCC_CFGR_PPRE2_DIV8                 (0x6U << 13)
+#define RCC_CFGR_PPRE2_DIV16                (0x7U << 13)
+
+/********************  Bit definition for RCC_AHB1xxx registers  **************/
+#define RCC_AHB1ENR_GPIOAEN_Pos             (0U)
+#define RCC_AHB1ENR_GPIOBEN_Pos             (1U)
+#define RCC_AHB1ENR_GPIOCEN_Pos             (2U)
+#define RCC_AHB1ENR_CRCEN_Pos               (12U)
+#define RCC_AHB1ENR_CRCEN                   (0x1U << RCC_AHB1ENR_CRCEN_Pos)
+#define RCC_AHB2ENR_OTGFSEN_Pos             (7U)
+#define RCC_APB1ENR_PWREN_Pos               (28U)
+#define RCC_APB2ENR_USART1EN_Pos            (4U)
+#define RCC_APB2ENR_SYSCFGEN_Pos            (14U)
+
+/********************  Bit definition for RCC_BDCR / RCC_CSR registers  *******/
+#define RCC_BDCR_LSEON_Pos                  (0U)
+#define RCC_CSR_LSION_Pos                   (0U)
+#define RCC_CSR_RMVF                        (0x1U << 24)
+
+/********************  Bit definition for USB_OTG registers  ******************/
+#define USB_OTG_GAHBCFG_GINT                (0x1U << 0)
+
+#define USB_OTG_GUSBCFG_PHYSEL              (0x1U << 6)
+#define USB_OTG_GUSBCFG_TRDT_Pos            (10U)
+#define USB_OTG_GUSBCFG_TRDT                (0xFU << USB_OTG_GUSBCFG_TRDT_Pos)
+#define USB_OTG_GUSBCFG_FDMOD               (0x1U << 30)
+
+#define USB_OTG_GRSTCTL_CSRST               (0x1U << 0)
+#define USB_OTG_GRSTCTL_RXFFLSH             (0x1U << 4)
+#define USB_OTG_GRSTCTL_TXFFLSH             (0x1U << 5)
+#define USB_OTG_GRSTCTL_TXFNUM_Pos          (6U)
+#define USB_OTG_GRSTCTL_AHBIDL              (0x1U << 31)
+
+#define USB_OTG_GINTSTS_SOF                 (0x1U << 3)
+#define USB_OTG_GINTSTS_RXFLVL              (0x1U << 4)
+#define USB_OTG_GINTSTS_USBSUSP             (0x1U << 11)
+#define USB_OTG_GINTSTS_USBRST              (0x1U << 12)
+#define USB_OTG_GINTSTS_ENUMDNE             (0x1U << 13)
+#define USB_OTG_GINTSTS_IEPINT              (0x1U << 18)
+#define USB_OTG_GINTSTS_OEPINT              (0x1U << 19)
+#define USB_OTG_GINTSTS_WKUINT              (0x1U << 31)
+
+#define USB_OTG_GRXSTSP_EPNUM               (0xFU << 0)
+#define USB_OTG_GRXSTSP_BCNT_Pos            (4U)
+#define USB_OTG_GRXSTSP_BCNT                (0x7FFU << USB_OTG_GRXSTSP_BCNT_Pos)
+#define USB_OTG_GRXSTSP_PKTSTS_Pos          (17U)
+#define USB_OTG_GRXSTSP_PKTSTS              (0xFU << USB_OTG_GRXSTSP_PKTSTS_Pos)
+
+#define USB_OTG_GCCFG_PWRDWN                (0x1U << 16)
+#define USB_OTG_GCCFG_NOVBUSSENS            (0x1U << 21)
+
+#define USB_OTG_DCFG_DSPD                   (0x3U << 0)
+#define USB_OTG_DCFG_DAD_Pos                (4U)
+#define USB_OTG_DCFG_DAD                    (0x7FU << USB_OTG_DCFG_DAD_Pos)
+
+#define USB_OTG_DCTL_RWUSIG                 (0x1U << 0)
+#define USB_OTG_DCTL_SDIS                   (0x1U << 1)
+#define USB_OTG_DCTL_CGINAK                 (0x1U << 8)
+
+#define USB_OTG_DEPCTL_MPSIZ                (0x7FFU << 0)
+#define USB_OTG_DEPCTL_USBAEP               (0x1U << 15)
+#define USB_OTG_DEPCTL_EPTYP_Pos            (18U)
+#define USB_OTG_DEPCTL_STALL                (0x1U << 21)
+#define USB_OTG_DEPCTL_TXFNUM_Pos           (22U)
+#define USB_OTG_DEPCTL_CNAK                 (0x1U << 26)
+#define USB_OTG_DEPCTL_SNAK                 (0x1U << 27)
+#define USB_OTG_DEPCTL_SD0PID               (0x1U << 28)
+#define USB_OTG_DEPCTL_EPDIS                (0x1U << 30)
+#define USB_OTG_DEPCTL_EPENA                (0x1U << 31)
+
+#define USB_OTG_DEPINT_XFRC                 (0x1U << 0)
+#define USB_OTG_DOEPINT_STUP                (0x1U << 3)
+
+#define USB_OTG_DEPTSIZ_XFRSIZ              (0x7FFFFU << 0)
+#define USB_OTG_DEPTSIZ_PKTCNT_Pos          (19U)
+#define USB_OTG_DOEPTSIZ_STUPCNT_Pos        (29U)
+
+#define USB_OTG_PCGCCTL_STOPCLK             (0x1U << 0)
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __STM32F4xx_H */
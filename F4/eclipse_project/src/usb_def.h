@@ -0,0 +1,84 @@
+#ifndef USB_DEF_H
+#define USB_DEF_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "usb_desc.h"
+
+//-----------------------------------------------------------------------------
+// Drive USB as virtual COM port, over the OTG FS core in device mode
+//-----------------------------------------------------------------------------
+
+/* The name of the IRQ handler must match startup_stm32.S */
+#define NAME_OF_USB_IRQ_HANDLER OTG_FS_IRQHandler
+
+/* Take the number from the reference manual of your C. */
+#define USB_IRQ_NUMBER 67
+
+// Count frames and EP_DATA traffic per frame, see CMD_STATS. Not implemented on the OTG core.
+#define USB_FRAME_STATS 0
+
+// Leave USB enumerated when jumping to the user program, see boot_handoff.h.
+// The saved state is the one of the USB FS device (F1, F3), not supported here.
+#define USB_KEEP_ON_HANDOFF 0
+
+// Enable trace messages
+#define ENABLE_TRACING 0
+
+#if ENABLE_TRACING
+    #include <stdio.h>
+
+    #define ITM_PORT0_8   (*(volatile char *)(0xE0000000UL))
+    #define ITM_PORT0_32  (*(volatile unsigned long *)(0xE0000000UL))
+    #define ITM_TER       (*(volatile unsigned long *)(0xE0000E00UL))
+    #define ITM_TCR       (*(volatile unsigned long *)(0xE0000E80UL))
+
+    static void trace(char *ptr)
+    {
+        while (*ptr)
+        {
+            if (((ITM_TCR & 1UL) != 0UL) &&   // ITM enabled
+                ((ITM_TER & 1UL) != 0UL))     // ITM and port 0 enabled
+            {
+                while (ITM_PORT0_32 == 0UL)
+                {
+                    asm volatile("NOP");
+                }
+                ITM_PORT0_8 = *ptr++;
+            }
+        }
+    }
+#else
+#include "libmaple/systick.h"
+	// the USB_DEBUG build logs binary events with etrace(), see usb_trace.h
+	#define trace(...)
+	#define ntrace(d,nl)
+#define strace(...)
+#endif
+
+#include "usb_trace.h"
+
+
+/*
+ Layout of the OTG FS FIFO RAM (1.25 KB, in 32 bit words), see usb_otg.c
+
+ RX FIFO (shared by all OUT EPs)   128 words
+ TX FIFO EP0 (CTRL)                 32 words
+ TX FIFO EP1 (DATA)                 32 words
+ TX FIFO EP2 (COMM)                 16 words
+
+ The received packets are copied from the RX FIFO into a RAM buffer per EP.
+ */
+#define EP_DATA_LEN   64
+
+#define EP_INT_MAX_LEN    8
+
+#define OTG_RX_FIFO_WORDS		128
+#define OTG_TX0_FIFO_WORDS		32
+#define OTG_TX1_FIFO_WORDS		32
+#define OTG_TX2_FIFO_WORDS		16
+
+#include "usb_traits.h"
+
+
+#endif // USB_DEF_H
@@ -0,0 +1,253 @@
+
+#ifndef USB_FUNC_H
+#define USB_FUNC_H
+
+#include <stdint.h>
+#include "usb_def.h"
+#include "usb_desc.h"
+#include "cdc.h"
+#include "gpio.h"
+#include "flash.h"
+#include "dwt.h"
+#include "boot_handoff.h"
+#include "nvic.h"
+
+
+/******* Struktur des Setup-Paketes *****/
+typedef struct
+{
+    uint8_t bmRequestType; /* siehe oben */
+    uint8_t bRequest;      /* siehe Request-Tafel in USB-Doku */
+    uint16_t wValue;        /* je nach Request */
+    uint16_t wIndex;        /* je nach Request */
+    uint16_t wLength;       /* Anzahl Bytes, wenn Data-Stage vorhanden ist */
+} setupPaket_t;
+
+/******* Struktur des Kommando- und Org-Datenblockes *******************/
+typedef struct
+{
+    setupPaket_t setupPacket; /* das jeweils letzte Setup-Paket   */
+    int transferLen;               /* noch zum Host zu sendende Anzahl Bytes */
+    int packetLen;                 /* wie lang das Paket zum Host sein darf */
+    uint8_t* transferPtr;              /* zeigt auf die noch zu sendenden Bytes */
+
+    bool remoteWakeup;
+    bool selfPowered;
+    int configuration;
+} command_t;
+
+typedef union status_t {
+	// access as 16 bit in one read instruction
+	uint16_t both;
+	// -- or as separate 8 bit values --
+	struct {
+		uint8_t suspended;
+		uint8_t configured;
+	};
+} status_t;
+
+/* Line coding structure
+ 0-3 BaudRate     Data terminal rate (baudrate), in bits per second
+ 4   bCharFormat  Stop bits: 0 - 1 Stop bit, 1 - 1.5 Stop bits, 2 - 2 Stop bits
+ 5   bParityType  Parity:    0 - None, 1 - Odd, 2 - Even, 3 - Mark, 4 - Space
+ 6   bDataBits    Data bits: 5, 6, 7, 8, 16
+ */
+
+#define lineCoding_t usb_cdc_line_coding
+
+extern command_t CMD;
+extern lineCoding_t lineCoding;
+extern uint16_t Dtr_Rts;
+extern const uint8_t ZERO;
+
+extern void Class_Start(void);
+extern void Setup_flash();
+extern void Setup_clocks();
+
+extern int DataBeginTransmit();
+extern void DataBeginReceive(); // called when Rx data can be processed again
+extern int ReadControlBlock(uint8_t* pBuffer, int maxlen);
+extern int SendData(int ep, uint8_t* pBuffer, int count);
+extern void USB_save_state(boot_handoff_t * h);
+extern void USB_core_init(void); // usb_otg.c
+extern void USB_connect(void);
+//--------------------------------------------------------------------------
+static inline void EnableUsbIRQ (void)
+{
+	nvic_irq_enable(NVIC_OTG_FS);
+}
+//--------------------------------------------------------------------------
+static inline void DisableUsbIRQ (void)
+{
+	nvic_irq_disable(NVIC_OTG_FS);
+}
+//--------------------------------------------------------------------------
+static inline void ACK(void)
+{
+	SendData(EP_CTRL, (uint8_t*) &ZERO, 0);
+	trace("-ACK\n");
+}
+
+//-----------------------------------------------------------------------------
+static inline void USB_SetAddress(uint8_t adr)
+{
+	strace(buf,"setAddr adr=%i\n",adr);
+	OTG_DEVICE->DCFG = (OTG_DEVICE->DCFG & ~USB_OTG_DCFG_DAD) | (adr << USB_OTG_DCFG_DAD_Pos);
+}
+
+/* Request-Typ im Setup-Packet testen (Standard, Class, Vendor) */
+//--------------------------------------------------------------------------
+static inline bool IsStandardRequest(void)
+{
+    return (CMD.setupPacket.bmRequestType & 0x60) == 0;
+}
+
+//--------------------------------------------------------------------------
+static inline bool IsClassRequest(void)
+{
+    return (CMD.setupPacket.bmRequestType & 0x60) == 0x20;
+}
+
+//--------------------------------------------------------------------------
+static inline bool IsVendorRequest(void)
+{
+    return (CMD.setupPacket.bmRequestType & 0x60) == 0x40;
+}
+
+
+#define LED_ON		gpio_write_pin(LED_BUILTIN, 0)
+#define LED_OFF		gpio_write_pin(LED_BUILTIN, 1)
+
+//-----------------------------------------------------------------------------
+#define PAGE_SIZE			(2*1024)
+// Bootloader size: flash sector 0, the user program starts at sector 1
+#define BOOTLOADER_SIZE		(8 * PAGE_SIZE)
+
+// SRAM size
+#define SRAM_SIZE			(128 * 1024)
+
+// SRAM end (bottom of stack)
+#define SRAM_END			(SRAM_BASE + SRAM_SIZE)
+
+// CDC Bootloader takes 16 kb flash.
+#define USER_PROGRAM		(FLASH_BASE + BOOTLOADER_SIZE)
+
+// flash size (STM32F411CE) and the staging region at its end, see staging.h.
+// The staging region is sector 7, so slot A and B are erased separately.
+#define FLASH_SIZE			(512 * 1024)
+#define STAGING_SIZE		(128 * 1024)
+// 1: slot B is copied to USER_PROGRAM when activated, 0: both slots are executed in place
+#define BOOT_SLOT_SWAP		1
+//-----------------------------------------------------------------------------
+typedef union cmd_t {
+	uint8_t data[8];
+	struct {
+		uint16_t start; // 0x41BE
+		uint8_t id;
+		uint8_t page;
+		uint16_t data_len;
+		uint16_t crc;
+	};
+} __attribute((packed)) cmd_t;
+extern cmd_t cmd;
+
+// data stage of CMD_IMAGE
+typedef struct image_info_t {
+	uint32_t len;		// image length in bytes
+	uint16_t checksum;	// Calculate_CRC() of the image
+	uint16_t reserved;
+} __attribute((packed)) image_info_t;
+
+// entry of the segment table of CMD_SEGMENTS
+typedef struct segment_t {
+	uint32_t addr;		// flash address, page aligned
+	uint32_t len;		// bytes
+	uint32_t crc32;		// CRC-32 of the segment, as Image_crc()
+} __attribute((packed)) segment_t;
+#define SEGMENTS_MAX		4
+
+// command ids
+enum {
+	CMD_SESSION = 0x20,	// start of upload session, page = number of pages to flash, data_len = image version
+	CMD_PAGE = 0x21,	// page data follows, page = page number, data_len = number of bytes
+	CMD_STATS = 0x22,	// send back the frame statistics (usb_stats_t)
+	CMD_RUN = 0x23,		// end the session and start the program, data_len = vector table in pages from FLASH_BASE, 0 = active slot
+	CMD_RESET = 0x24,	// end the session and reset the MCU
+	CMD_SEGMENTS = 0x25,	// start of a segment session, page = number of segments, data_len = image version, the segment table follows
+	CMD_PATCH = 0x26,	// write bytes in place (read-modify-write of the page), data_len = number of bytes, the address (uint32_t) and the bytes follow
+	CMD_IMAGE = 0x27,	// optional, within a session: the image length and checksum (image_info_t) follow
+};
+
+extern int Check_CRC(uint8_t * buff, int len);
+extern int Calculate_CRC(uint8_t * buff, int len);
+extern void Ramfunc_load(void); // the __ramfunc code, before its first use (boot.c)
+
+// USB start-up (main.c) and the serial mode for the user program (see boot_api.h)
+extern void GpioToggle(void);
+extern void UsbSetup(void);
+extern void NAME_OF_USB_IRQ_HANDLER(void);
+extern status_t usb_state;
+extern bool usb_serial;
+extern bool Cdc_connected(void);
+extern int Cdc_available(void);
+extern int Cdc_read(uint8_t * buf, int max);
+extern int Cdc_write(const uint8_t * buf, int len);
+
+#define BAUD_RATE 230400
+
+typedef enum {BUF_EMPTY, BUF_RECEIVING, BUF_FULL, BUF_SENDING} buf_status_t;
+typedef enum {
+	NO_ERROR,
+	NO_SETUP,
+	NO_FREE_BUFFER,
+	DATA_OVERFLOW,
+	DATA_UNDEFLOW,
+	CMD_WRONG_LENGTH,
+	CMD_WRONG_CRC,
+	CMD_WRONG_ID,
+	CMD_WRONG_ADDRESS,
+	FLASH_VERIFY_FAILED,	// followed by the failing address (uint32_t), see flash_engine.h
+	SEGMENT_CRC_FAILED,	// followed by the index of the segment (uint8_t)
+	PATCH_NEEDS_ERASE,	// CMD_PATCH sets bits, not possible with the sector erase (F4)
+	ACTIVATE_FAILED		// followed by the STAGE_ERR_xxx of the activation (uint8_t), see staging.h
+} error_t;
+
+// frame statistics, see OnSof()
+#define USB_STATS_HIST	16
+
+typedef struct usb_stats_t {
+	uint32_t frames;		// number of elapsed frames (1 ms each)
+	uint32_t missed_sofs;	// number of ESOF events
+	uint32_t data_frames;	// frames with traffic on EP_DATA
+	uint32_t idle_frames;	// frames without traffic on EP_DATA during an upload
+	uint32_t bytes;			// bytes moved on EP_DATA (both directions)
+	uint32_t config_us;		// time from reset to the first SET_CONFIGURATION, see Boot_time_us()
+	uint16_t max_frame_bytes;	// most bytes moved within one frame
+	uint16_t hist[USB_STATS_HIST];	// frames by number of EP_DATA packets, the last entry counts all above
+	uint32_t verify_us;		// time spent in the read-back verify of the flash writes
+	uint32_t verify_retries;	// pages erased and written again after a failed verify
+} usb_stats_t;
+extern usb_stats_t usb_stats;
+
+// The DWT cycle counter is started at reset. The clock setup runs from HSI,
+// its cycles are stored in clock_cycles, then the counter restarts at F_CPU.
+#define HSI_MHZ			16
+extern uint32_t clock_cycles;
+static inline uint32_t Boot_time_us(void)
+{
+	return clock_cycles/HSI_MHZ + dwt_cycles()/(F_CPU/1000000);
+}
+
+extern int num_pages; // number of total pages to flash
+extern int crt_page, page_offset;
+extern uint32_t upload_base; // slot the upload is written into
+extern uint16_t upload_version;
+extern uint32_t run_address; // CMD_RUN, 0 = active slot
+extern int header_ok;
+extern bool Upload_activate(void);
+extern void Command_activate(void);
+//-----------------------------------------------------------------------------
+
+
+
+#endif // USB_FUNC_H
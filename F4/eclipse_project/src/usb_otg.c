@@ -0,0 +1,392 @@
+/*
+ * usb_otg.c
+ *
+ * USB device driver for the OTG FS core of the F4, in device mode.
+ * Implements the driver interface of usb_cmd.h like common/usb.c does for
+ * the USB FS device of F1 and F3, the control requests (usb_ctrl.c) and the
+ * upload protocol (usb_cmd.c) are shared.
+ *
+ * The core has no packet memory per EP but one RX FIFO for all OUT EPs and a
+ * TX FIFO per IN EP. A received packet is popped from the RX FIFO into the
+ * RAM buffer of its EP, then the EP is disabled and answers with NAK till
+ * MarkBufferRxDone() enables it again, same as STAT_RX of the FS device.
+ * Each OUT and IN transfer is one packet (PKTCNT = 1).
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "usb_std.h"
+#include "usb_func.h"
+#include "usb_desc.h"
+#include "usb_cmd.h"
+
+//-----------------------------------------------------------------------------
+//  Variables
+//-----------------------------------------------------------------------------
+// received packets, one buffer per OUT EP (EP_COMM has no OUT direction)
+static uint32_t rx_buf[EP_COMM][EP_DATA_LEN/4];
+static uint16_t rx_len[EP_COMM];
+
+//-----------------------------------------------------------------------------
+// helper routines
+//-----------------------------------------------------------------------------
+// an IN endpoint (bit 7 set) is stalled on the TX side, an OUT endpoint on the RX side
+//-----------------------------------------------------------------------------
+void Stall_EPAddr(int epNum)
+{
+	trace("stall\n");
+	etrace(TR_STALL, epNum, 0);
+
+	if ( epNum & 0x80 ) // IN EP
+		OTG_IN_EP(epNum & 0x7F)->DIEPCTL |= USB_OTG_DEPCTL_STALL;
+	else
+		OTG_OUT_EP(epNum)->DOEPCTL |= USB_OTG_DEPCTL_STALL;
+}
+//-----------------------------------------------------------------------------
+// the data toggle of a bulk or interrupt EP restarts with DATA0
+//-----------------------------------------------------------------------------
+void UnStall_EPAddr(int epNum)
+{
+	trace("unstall\n");
+	etrace(TR_UNSTALL, epNum, 0);
+
+	if ( epNum & 0x80 ) // IN EP
+	{
+		__IO uint32_t * ctl = &OTG_IN_EP(epNum & 0x7F)->DIEPCTL;
+		*ctl = (*ctl & ~USB_OTG_DEPCTL_STALL) | ((epNum & 0x7F) ? USB_OTG_DEPCTL_SD0PID : 0);
+	}
+	else
+	{
+		__IO uint32_t * ctl = &OTG_OUT_EP(epNum)->DOEPCTL;
+		*ctl = (*ctl & ~USB_OTG_DEPCTL_STALL) | (epNum ? USB_OTG_DEPCTL_SD0PID : 0);
+	}
+}
+
+//-----------------------------------------------------------------------------
+void Stall(int ep)
+{
+	Stall_EPAddr(USB_EP_ADDR_OUT(ep));
+	Stall_EPAddr(USB_EP_ADDR_IN(ep));
+}
+//-----------------------------------------------------------------------------
+void UnStall(int ep)
+{
+	UnStall_EPAddr(USB_EP_ADDR_OUT(ep));
+	UnStall_EPAddr(USB_EP_ADDR_IN(ep));
+}
+
+//-----------------------------------------------------------------------------
+// mark EP ready to receive: one packet, EP0 also accepts 3 back-to-back SETUPs
+//-----------------------------------------------------------------------------
+__ramfunc void MarkBufferRxDone(int ep)
+{
+	strace("clrBuf logEpNum=%i\n", ep);
+	USB_OTG_OUTEndpoint_reg_def * out = OTG_OUT_EP(ep);
+	if ( out->DOEPCTL & USB_OTG_DEPCTL_EPENA )
+		return; // still enabled, no packet received since
+	out->DOEPTSIZ = (1 << USB_OTG_DEPTSIZ_PKTCNT_Pos) | EP_DATA_LEN |
+		((ep==EP_CTRL) ? (3 << USB_OTG_DOEPTSIZ_STUPCNT_Pos) : 0);
+	out->DOEPCTL |= USB_OTG_DEPCTL_CNAK | USB_OTG_DEPCTL_EPENA;
+}
+
+//-----------------------------------------------------------------------------
+// flush the TX FIFO of the IN EP, or all with 0x10
+//-----------------------------------------------------------------------------
+static void Flush_tx_fifo(int num)
+{
+	USB_OTG_FS->GRSTCTL = USB_OTG_GRSTCTL_TXFFLSH | (num << USB_OTG_GRSTCTL_TXFNUM_Pos);
+	while ( USB_OTG_FS->GRSTCTL & USB_OTG_GRSTCTL_TXFFLSH );
+}
+
+//-----------------------------------------------------------------------------
+// initialize the EPs, on bus reset
+//-----------------------------------------------------------------------------
+void InitEndpoints(void)
+{
+	trace("InitEPs\n");
+	CMD.configuration = 0;
+	CMD.transferLen = 0;   // no transfers
+	CMD.packetLen = 0;
+	CMD.transferPtr = 0;
+	usb_state.suspended = false;
+	usb_state.configured = false;
+
+	OTG_DEVICE->DCTL &= ~USB_OTG_DCTL_RWUSIG;
+	Flush_tx_fifo(0x10);
+	for (int ep = 0; ep < EP_LAST; ep++)
+	{
+		OTG_IN_EP(ep)->DIEPINT = 0xFF;
+		OTG_OUT_EP(ep)->DOEPINT = 0xFF;
+		OTG_OUT_EP(ep)->DOEPCTL |= USB_OTG_DEPCTL_SNAK;
+	}
+	// the EP interrupts used: transfer completed, SETUP done on EP0
+	OTG_DEVICE->DAINTMSK = (1<<EP_CTRL) | (1<<EP_DATA) | (1<<(16+EP_CTRL)) | (1<<(16+EP_DATA));
+	OTG_DEVICE->DOEPMSK = USB_OTG_DOEPINT_STUP | USB_OTG_DEPINT_XFRC;
+	OTG_DEVICE->DIEPMSK = USB_OTG_DEPINT_XFRC;
+
+	USB_SetAddress(0);
+	MarkBufferRxDone(EP_CTRL);
+}
+
+//-----------------------------------------------------------------------------
+// enumeration done (full speed): activate the EPs of the descriptors
+// see usb_desc.c: EP_DATA_IN, EP_DATA_OUT, EP_COMM_IN
+//-----------------------------------------------------------------------------
+static void ActivateEndpoints(void)
+{
+	OTG_IN_EP(EP_CTRL)->DIEPCTL &= ~USB_OTG_DEPCTL_MPSIZ; // 0 = 64 bytes
+
+	OTG_IN_EP(EP_DATA)->DIEPCTL = EP_DATA_LEN | (2 << USB_OTG_DEPCTL_EPTYP_Pos) | // Bulk
+		(EP_DATA << USB_OTG_DEPCTL_TXFNUM_Pos) | USB_OTG_DEPCTL_SD0PID | USB_OTG_DEPCTL_USBAEP;
+	OTG_OUT_EP(EP_DATA)->DOEPCTL = EP_DATA_LEN | (2 << USB_OTG_DEPCTL_EPTYP_Pos) |
+		USB_OTG_DEPCTL_SD0PID | USB_OTG_DEPCTL_USBAEP;
+	OTG_IN_EP(EP_COMM)->DIEPCTL = EP_INT_MAX_LEN | (3 << USB_OTG_DEPCTL_EPTYP_Pos) | // Int
+		(EP_COMM << USB_OTG_DEPCTL_TXFNUM_Pos) | USB_OTG_DEPCTL_SD0PID | USB_OTG_DEPCTL_USBAEP;
+
+	MarkBufferRxDone(EP_DATA);
+	OTG_DEVICE->DCTL |= USB_OTG_DCTL_CGINAK;
+}
+
+//-----------------------------------------------------------------------------
+// set up the core in device mode, the pull-up on D+ stays off (SDIS)
+// till USB_connect(), see UsbSetup()
+//-----------------------------------------------------------------------------
+void USB_core_init(void)
+{
+	USB_OTG_FS->GAHBCFG = 0; // global interrupt off
+	USB_OTG_FS->GUSBCFG |= USB_OTG_GUSBCFG_PHYSEL;
+
+	// core soft reset
+	while ( !(USB_OTG_FS->GRSTCTL & USB_OTG_GRSTCTL_AHBIDL) );
+	USB_OTG_FS->GRSTCTL = USB_OTG_GRSTCTL_CSRST;
+	while ( USB_OTG_FS->GRSTCTL & USB_OTG_GRSTCTL_CSRST );
+
+	// device mode, turnaround time for AHB > 32 MHz
+	USB_OTG_FS->GUSBCFG = USB_OTG_GUSBCFG_PHYSEL | USB_OTG_GUSBCFG_FDMOD | (6 << USB_OTG_GUSBCFG_TRDT_Pos);
+	dwt_delay_us(25*1000); // the forced mode takes effect after 25 ms
+
+	// transceiver on, VBUS is not sensed (PA9 is free for the user program)
+	USB_OTG_FS->GCCFG = USB_OTG_GCCFG_PWRDWN | USB_OTG_GCCFG_NOVBUSSENS;
+	OTG_PCGCCTL = 0;
+
+	OTG_DEVICE->DCTL = USB_OTG_DCTL_SDIS;
+	OTG_DEVICE->DCFG = USB_OTG_DCFG_DSPD; // full speed, internal PHY
+
+	// FIFO RAM, see usb_def.h
+	USB_OTG_FS->GRXFSIZ = OTG_RX_FIFO_WORDS;
+	USB_OTG_FS->DIEPTXF0_HNPTXFSIZ = (OTG_TX0_FIFO_WORDS << 16) | OTG_RX_FIFO_WORDS;
+	USB_OTG_FS->DIEPTXF[EP_DATA-1] = (OTG_TX1_FIFO_WORDS << 16) | (OTG_RX_FIFO_WORDS + OTG_TX0_FIFO_WORDS);
+	USB_OTG_FS->DIEPTXF[EP_COMM-1] = (OTG_TX2_FIFO_WORDS << 16) | (OTG_RX_FIFO_WORDS + OTG_TX0_FIFO_WORDS + OTG_TX1_FIFO_WORDS);
+	Flush_tx_fifo(0x10);
+	USB_OTG_FS->GRSTCTL = USB_OTG_GRSTCTL_RXFFLSH;
+	while ( USB_OTG_FS->GRSTCTL & USB_OTG_GRSTCTL_RXFFLSH );
+
+	USB_OTG_FS->GINTSTS = 0xFFFFFFFF; // clear pending interrupts
+	USB_OTG_FS->GINTMSK =
+		USB_OTG_GINTSTS_RXFLVL |		// packet in the RX FIFO
+		USB_OTG_GINTSTS_IEPINT | USB_OTG_GINTSTS_OEPINT |
+		USB_OTG_GINTSTS_USBRST | USB_OTG_GINTSTS_ENUMDNE |
+		USB_OTG_GINTSTS_USBSUSP | USB_OTG_GINTSTS_WKUINT;
+	USB_OTG_FS->GAHBCFG = USB_OTG_GAHBCFG_GINT;
+}
+//-----------------------------------------------------------------------------
+// pull-up on D+ on, the host starts the enumeration
+//-----------------------------------------------------------------------------
+void USB_connect(void)
+{
+	OTG_DEVICE->DCTL &= ~USB_OTG_DCTL_SDIS;
+}
+
+//-----------------------------------------------------------------------------
+// number of bytes received on the EP
+//-----------------------------------------------------------------------------
+__ramfunc uint16_t Ep_rx_count(int ep)
+{
+	return rx_len[ep];
+}
+//-----------------------------------------------------------------------------
+// reads up to a given number of bytes from the EP receive buffer
+//-----------------------------------------------------------------------------
+__ramfunc void ReadData(int ep, uint8_t* dest, int count)
+{
+	int rd = Ep_rx_count(ep);
+	if (count>rd)
+		count = rd;
+	etrace(TR_RX, ep, count);
+	memcpy(dest, rx_buf[ep], count);
+	if (ep==EP_CTRL)
+		MarkBufferRxDone(EP_CTRL); // release EP0 Rx
+}
+//-----------------------------------------------------------------------------
+// writes up to 64 bytes into the TX FIFO of the specified EP
+//-----------------------------------------------------------------------------
+__ramfunc int SendData(int ep, uint8_t * src, int count)
+{
+	trace("tx="); ntrace(count, 0);
+
+	if (count > EP_DATA_LEN)
+		count = EP_DATA_LEN;
+	etrace(TR_TX, ep, count);
+
+	USB_OTG_INEndpoint_reg_def * in = OTG_IN_EP(ep);
+	in->DIEPTSIZ = (1 << USB_OTG_DEPTSIZ_PKTCNT_Pos) | count;
+	in->DIEPCTL |= USB_OTG_DEPCTL_CNAK | USB_OTG_DEPCTL_EPENA;
+	// the FIFO is written with whole words
+	for (int i = 0; i < count; i += 4)
+	{
+		uint32_t val;
+		memcpy(&val, src + i, 4);
+		OTG_FIFO(ep) = val;
+	}
+	return count;
+}
+
+//-----------------------------------------------------------------------------
+// pop a status entry of the RX FIFO and its data
+//-----------------------------------------------------------------------------
+__ramfunc static void OnRxFifo(void)
+{
+	uint32_t sts = USB_OTG_FS->GRXSTSP;
+	int ep = sts & USB_OTG_GRXSTSP_EPNUM;
+	int len = (sts & USB_OTG_GRXSTSP_BCNT) >> USB_OTG_GRXSTSP_BCNT_Pos;
+	int pktsts = (sts & USB_OTG_GRXSTSP_PKTSTS) >> USB_OTG_GRXSTSP_PKTSTS_Pos;
+
+	if ( pktsts!=2 && pktsts!=6 )
+		return; // transfer or setup stage completed, see OnOutEp()
+
+	// 2: OUT data packet, 6: SETUP packet (8 bytes)
+	uint32_t * dest = (ep < EP_COMM) ? rx_buf[ep] : NULL;
+	for (int i = 0; i < len; i += 4)
+	{
+		uint32_t val = OTG_FIFO(0); // any FIFO address pops the RX FIFO
+		if ( dest && i < EP_DATA_LEN )
+			*dest++ = val;
+	}
+	if ( dest )
+		rx_len[ep] = (len > EP_DATA_LEN) ? EP_DATA_LEN : len;
+}
+
+//-----------------------------------------------------------------------------
+__ramfunc static void OnOutEp(int ep)
+{
+	USB_OTG_OUTEndpoint_reg_def * out = OTG_OUT_EP(ep);
+	uint32_t epint = out->DOEPINT;
+	out->DOEPINT = epint;
+
+	trace("->");
+
+	if (ep == EP_CTRL)
+	{
+		if (epint & USB_OTG_DOEPINT_STUP)
+		{
+			trace("SETUP-");
+			OnSetup(); // Handle the Setup-Packet
+			// Apply new device address, the core keeps the old one for the status stage
+			if (deviceAddress)
+			{
+				USB_SetAddress(deviceAddress);
+				deviceAddress = 0;
+			}
+		}
+		else if (epint & USB_OTG_DEPINT_XFRC)
+		{
+			trace("OUT-");
+			etrace(TR_CTRL_OUT, ep, 0);
+			OnEpCtrlOut(); // finished TX on CTRL endpoint
+		}
+		MarkBufferRxDone(EP_CTRL); // ready for the next stage
+	}
+	else if (ep == EP_DATA && (epint & USB_OTG_DEPINT_XFRC))
+	{
+		trace("DATA-");
+		etrace(TR_BULK_OUT, ep, Ep_rx_count(ep));
+		OnEpBulkOut();
+	}
+}
+
+//-----------------------------------------------------------------------------
+__ramfunc static void OnInEp(int ep)
+{
+	USB_OTG_INEndpoint_reg_def * in = OTG_IN_EP(ep);
+	uint32_t epint = in->DIEPINT;
+	in->DIEPINT = epint;
+	if ( !(epint & USB_OTG_DEPINT_XFRC) )
+		return;
+
+	trace("<-");
+
+	if (ep == EP_CTRL)
+	{
+		trace("CTRL-");
+		etrace(TR_CTRL_IN, ep, 0);
+		OnEpCtrlIn();
+	}
+	else if (ep == EP_DATA)
+	{
+		trace("DATA-");
+		etrace(TR_BULK_IN, ep, 0);
+		OnEpBulkIn();
+	}
+}
+
+//-----------------------------------------------------------------------------
+//--------------- USB-Interrupt-Handler ---------------------------------------
+// The handler and the data endpoint path are executed from SRAM (__ramfunc),
+// so packets are served while the flash is erased or written. The control
+// requests (OnSetup) still run from flash, they are not expected then.
+//-----------------------------------------------------------------------------
+__ramfunc void NAME_OF_USB_IRQ_HANDLER(void)
+{
+	uint32_t irqStatus = USB_OTG_FS->GINTSTS & USB_OTG_FS->GINTMSK;
+
+	if (irqStatus & USB_OTG_GINTSTS_WKUINT) // Suspend-->Resume
+	{
+		trace("WKUP\n");
+		etrace(TR_WAKEUP, 0, 0);
+		OTG_PCGCCTL &= ~USB_OTG_PCGCCTL_STOPCLK;
+		usb_state.suspended = false;
+	}
+	else if (irqStatus & USB_OTG_GINTSTS_USBSUSP) // after 3 ms break -->Suspend
+	{
+		trace("SUSP\n");
+		etrace(TR_SUSPEND, 0, 0);
+		usb_state.suspended = true;
+	}
+	USB_OTG_FS->GINTSTS = irqStatus & (USB_OTG_GINTSTS_WKUINT | USB_OTG_GINTSTS_USBSUSP |
+		USB_OTG_GINTSTS_USBRST | USB_OTG_GINTSTS_ENUMDNE); // clear, the others are read-only
+
+	if (irqStatus & USB_OTG_GINTSTS_USBRST) // Bus Reset
+	{
+		trace("RESET\n");
+		etrace(TR_RESET, 0, 0);
+		InitEndpoints();
+	}
+	if (irqStatus & USB_OTG_GINTSTS_ENUMDNE)
+		ActivateEndpoints();
+
+	while ( USB_OTG_FS->GINTSTS & USB_OTG_GINTSTS_RXFLVL )
+		OnRxFifo();
+
+	if (irqStatus & USB_OTG_GINTSTS_OEPINT) // OUT packet sent by host and received by device
+	{
+		uint32_t daint = OTG_DEVICE->DAINT >> 16;
+		for (int ep = 0; daint; ep++, daint >>= 1)
+			if (daint & 1)
+				OnOutEp(ep);
+	}
+	if (irqStatus & USB_OTG_GINTSTS_IEPINT) // IN, finished packet transmitted from device to host
+	{
+		uint32_t daint = OTG_DEVICE->DAINT & 0xFFFF;
+		for (int ep = 0; daint; ep++, daint >>= 1)
+			if (daint & 1)
+				OnInEp(ep);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// the OTG core is powered, see Api_usb_begin()
+//-----------------------------------------------------------------------------
+bool USB_running(void)
+{
+	return (USB_OTG_FS->GCCFG & USB_OTG_GCCFG_PWRDWN) != 0;
+}
@@ -0,0 +1,28 @@
+/*
+ * usb_traits.h
+ *
+ * STM32F4 specific part of the USB driver. The F4 has the OTG FS core
+ * instead of the USB FS device of F1 and F3: common/usb.c is left out
+ * (USB_OTG), the driver is usb_otg.c of this project. It implements the
+ * same interface (usb_cmd.h), so the control requests and the upload
+ * protocol are shared.
+ */
+
+#ifndef USB_TRAITS_H
+#define USB_TRAITS_H
+
+#include "stm32f4xx.h"
+
+#define USB_OTG						1
+
+// the page header contains the page number (offset from USER_PROGRAM) to write
+#define USB_PAGE_FROM_HEADER		1
+
+// OTG FS register blocks
+#define OTG_DEVICE			((USB_OTG_Device_reg_def *)(USB_OTG_FS_PERIPH_BASE + USB_OTG_DEVICE_BASE))
+#define OTG_IN_EP(ep)		((USB_OTG_INEndpoint_reg_def *)(USB_OTG_FS_PERIPH_BASE + USB_OTG_IN_ENDPOINT_BASE + (ep)*USB_OTG_EP_REG_SIZE))
+#define OTG_OUT_EP(ep)		((USB_OTG_OUTEndpoint_reg_def *)(USB_OTG_FS_PERIPH_BASE + USB_OTG_OUT_ENDPOINT_BASE + (ep)*USB_OTG_EP_REG_SIZE))
+#define OTG_FIFO(ep)		(*(__IO uint32_t *)(USB_OTG_FS_PERIPH_BASE + USB_OTG_FIFO_BASE + (ep)*USB_OTG_FIFO_SIZE))
+#define OTG_PCGCCTL			(*(__IO uint32_t *)(USB_OTG_FS_PERIPH_BASE + USB_OTG_PCGCCTL_BASE))
+
+#endif // USB_TRAITS_H
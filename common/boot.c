@@ -0,0 +1,254 @@
+/*
+ * boot.c
+ *
+ * Start-up of the bootloader, see boot.h
+ */
+
+#include <string.h>
+
+#include "usb_func.h"
+#include "systick.h"
+#include "nvic.h"
+
+#include "boot.h"
+#include "staging.h"
+#include "image.h"
+#include "events.h"
+#include "flash_engine.h"
+
+
+
+volatile uint32_t main_events; // EV_x, see events.h
+uint32_t clock_cycles; // DWT cycles of the clock setup, see Boot_time_us()
+uint32_t verify_us; // time of the user code check, see Boot_reason()
+static bool usb_started; // the USB state is reported in the handoff block
+boot_handoff_t boot_handoff __attribute__((section(".handoff")));
+extern uint8_t g_pfnVectors[], _sram_vectors[], _eram_vectors[]; // see LinkerScript.ld
+extern uint8_t _siramfunc[], _sramfunc[], _eramfunc[];
+bool ramfunc_loaded __attribute__((section(".ramfunc_state"))); // see Ramfunc_load()
+
+//-----------------------------------------------------------------------------
+__ramfunc int Check_CRC(uint8_t * buff, int len)
+{
+	if (len<=2) return 0;
+	len -= 2; // don't process the last two bytes, they are the CRC
+
+	uint16_t crc = 0;
+	while ( (len--)>0 )
+		crc += (*buff++);
+
+	crc ^= 0xFFFF;
+
+	uint16_t temp = (*buff++);
+	temp |= (*buff)<<8;
+
+	return (crc==temp);
+}
+//-----------------------------------------------------------------------------
+int Calculate_CRC(uint8_t * buff, int len)
+{
+	if (len==0) return 0;
+
+	uint16 crc = 0xFFFF; // init CRC
+	while ( (len--)>0 )
+		crc += *buff++;
+
+	return (crc ^ 0xFFFF);
+}
+
+//-----------------------------------------------------------------------------
+// Enter the bootloader if:
+// - PB2 (BOOT 1 pin) is HIGH or
+// - no User Code is uploaded to the MCU or
+// - a reboot request was written into the SRAM by the user program or
+// - a magic word was stored in the battery-backed RAM registers by the user program
+// Runs directly after reset on HSI, only GPIOB is clocked for reading PB2.
+// An image not checked since its upload returns BOOT_CHECK_IMAGE, its full
+// check runs after the clock setup, see main().
+//-----------------------------------------------------------------------------
+#define BOOT_CHECK_IMAGE	(1<<15) // not a boot reason, see boot_handoff.h
+
+static uint16_t Boot_reason(void)
+{
+	// request in the SRAM, after a reset by the user program
+	if ( Boot_request_get_and_clear(BOOT_REQUEST) )
+		return BOOT_REASON_REQUEST;
+
+	if ( Get_and_clear_magic_word() == 0x424C )
+		return BOOT_REASON_MAGIC;
+
+	rcc_clk_enable(RCC_GPIOB);
+	bool boot1 = gpio_read_pin(PB2);
+	rcc_clk_disable(RCC_GPIOB);
+	if ( boot1 )
+		return BOOT_REASON_PB2;
+
+	uint32_t slot = Slot_active();
+	dwt_init();
+	bool valid = Check_user_code(slot);
+	bool checked = (slot!=SLOT_A_ADDR) || Image_checked();
+	verify_us = dwt_cycles() / HSI_MHZ;
+	if ( valid==false )
+		return BOOT_REASON_NO_APP;
+	return checked ? 0 : BOOT_CHECK_IMAGE;
+}
+//-----------------------------------------------------------------------------
+// fill in the handoff block for the user program, see boot_handoff.h
+//-----------------------------------------------------------------------------
+static void Handoff_prepare(uint16_t reason)
+{
+	memset(&boot_handoff, 0, sizeof(boot_handoff));
+	boot_handoff.boot_reason = reason;
+	Handoff_regs(&boot_handoff);
+	boot_handoff.page_size = PAGE_SIZE;
+	boot_handoff.slot = (Slot_active()==SLOT_B_ADDR) ? 1 : 0;
+	boot_handoff.verify_us = verify_us;
+	if ( clock_cycles )
+	{	// the bootloader did run, clocks are set up
+		boot_handoff.clocks = HANDOFF_CLOCKS_SET;
+		boot_handoff.sysclk_hz = F_CPU;
+		boot_handoff.boot_us = Boot_time_us();
+	}
+	else
+		boot_handoff.sysclk_hz = HSI_MHZ * 1000000; // HSI
+	if ( usb_started )
+	{	// the bootloader was active
+		boot_handoff.pages = num_pages;
+#if USB_FRAME_STATS
+		boot_handoff.config_us = usb_stats.config_us;
+#endif
+#if USB_KEEP_ON_HANDOFF
+		USB_save_state(&boot_handoff);
+#endif
+	}
+	Boot_handoff_seal(&boot_handoff);
+}
+//-----------------------------------------------------------------------------
+static void Jump_to_user_program(uint32_t user_address)
+{
+	voidFuncPtr UserProgram = (voidFuncPtr) *(volatile uint32_t *) (user_address + 0x04);
+
+	// Setup the vector table to the final user-defined one in Flash memory
+	nvic_set_vector_table(user_address, 0);
+
+	// Setup the stack pointer to the user-defined one
+	asm volatile ("MSR msp, %0" : : "r" (*(volatile uint32_t *) user_address) );
+
+	// Jump to the user program entry point
+	UserProgram();
+
+	// Never reached
+	while(1);
+}
+
+//-----------------------------------------------------------------------------
+// Take the exceptions from a copy of the vector table in SRAM, a vector fetch
+// from the flash would stall till an erase or write is done
+//-----------------------------------------------------------------------------
+static void Vectors_to_ram(void)
+{
+	memcpy(_sram_vectors, g_pfnVectors, _eram_vectors - _sram_vectors);
+	nvic_set_vector_table((uint32_t)_sram_vectors, 0);
+}
+
+//-----------------------------------------------------------------------------
+// Copy the code running from SRAM (__ramfunc) into the shared RAM, once.
+// Called before the first use: the bootloader staying active, a flash write
+// on the way to the user program, or a boot API function.
+//-----------------------------------------------------------------------------
+void Ramfunc_load(void)
+{
+	if ( ramfunc_loaded )
+		return;
+	memcpy(_sramfunc, _siramfunc, _eramfunc - _sramfunc);
+	ramfunc_loaded = true;
+}
+
+//-----------------------------------------------------------------------------
+int main(void)
+{
+	// the flag is random after power-on, or left by another build
+	ramfunc_loaded = false;
+	// a staged update is installed first, still on HSI
+	uint16_t staged = Stage_install();
+	uint16_t reason = Boot_reason();
+#ifndef DEBUG
+	// fast path: jump to the user program before any clock or GPIO setup
+	if ( reason==0 )
+	{
+		Handoff_prepare(staged);
+		Jump_to_user_program(Slot_active());
+	}
+#endif
+
+	dwt_init(); // start the boot time measurement
+	Setup_flash();
+	Setup_clocks();
+	clock_cycles = dwt_cycles(); // counted at HSI
+	dwt_init(); // from now on counting at F_CPU
+
+#ifndef DEBUG
+	if ( reason==BOOT_CHECK_IMAGE )
+	{	// first boot after an upload: the full check of the image, at F_CPU
+		uint32_t start = dwt_cycles();
+		bool valid = Image_valid();
+		verify_us = (dwt_cycles() - start) / (F_CPU/1000000);
+		if ( valid )
+		{
+			Handoff_prepare(staged);
+			Jump_to_user_program(Slot_active());
+		}
+		reason = BOOT_REASON_NO_APP;
+	}
+#endif
+
+	// Initialize GPIOs
+	IO_init();
+
+	Ramfunc_load();
+	Vectors_to_ram();
+	Main_init();
+	usb_started = true;
+
+#ifdef DEBUG
+	Debug_bridge();
+#endif
+
+	// wait till flash writing process is complete or the host ends the session
+	uint32_t ev;
+	while ( (ev = Event_take(EV_UPLOAD_DONE | EV_RUN | EV_RESET))==0 )
+	{
+		if ( Event_take(EV_ACTIVATE) )
+			Command_activate(); // CMD_RUN or CMD_RESET, not in the USB interrupt
+		Main_loop();
+	}
+	// let the flash engine finish the queued jobs
+	while ( !Flash_engine_idle() )
+		Event_wait();
+	Flash_engine_stop();
+
+	// turn off everything
+#if USB_KEEP_ON_HANDOFF
+	DisableUsbIRQ(); // the user program takes over the USB, see boot_handoff.h
+#else
+	USB_power_off();
+#endif
+	systick_disable();
+
+#if !USB_KEEP_ON_HANDOFF
+	// Turn GPIO clocks off
+	IO_deinit();
+#endif
+
+	if ( Upload_activate() )
+	{	// in swap mode the uploaded slot is copied to USER_PROGRAM
+		staged |= Stage_install();
+		reason |= BOOT_REASON_UPLOAD;
+	}
+	if ( ev & EV_RESET )
+		nvic_sys_reset();
+
+	// go and jump to user program, the clocks are left running
+	Handoff_prepare(reason | staged);
+	Jump_to_user_program( (ev & EV_RUN) && run_address ? run_address : Slot_active() );
+}
@@ -0,0 +1,33 @@
+/*
+ * boot.h
+ *
+ * Start-up of the bootloader, shared by all families, see boot.c
+ *
+ * main() decides after reset whether the user program is started or the
+ * bootloader stays active, runs the upload session and hands over to the
+ * user program. The board specific parts are the hooks below, implemented
+ * in src/main.c of each family.
+ */
+
+#ifndef BOOT_H
+#define BOOT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "boot_handoff.h"
+
+extern uint32_t verify_us; // time of the user code check, see Boot_reason()
+
+// board hooks (src/main.c)
+extern uint16_t Get_and_clear_magic_word(void); // backup register written by the user program
+extern void Handoff_regs(boot_handoff_t * h); // reset cause and clock configuration
+extern void IO_init(void);
+extern void IO_deinit(void);
+extern void USB_power_off(void);
+extern void Main_init(void); // USB and SysTick
+extern void Main_loop(void); // sleep till an event, the LED
+#ifdef DEBUG
+extern void Debug_bridge(void); // never returns
+#endif
+
+#endif // BOOT_H
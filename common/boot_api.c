@@ -0,0 +1,74 @@
+/*
+ * boot_api.c
+ *
+ * Function table exported to the user program, see boot_api.h
+ */
+
+#include "usb_func.h"
+#include "usb_cmd.h"
+#include "boot_api.h"
+#include "staging.h"
+
+//-----------------------------------------------------------------------------
+// start USB in serial mode. If the bootloader has left the device enumerated
+// (USB_KEEP_ON_HANDOFF), only the interrupt is enabled again.
+//-----------------------------------------------------------------------------
+static void Api_usb_begin(void)
+{
+	Ramfunc_load(); // not done if the bootloader started the user program directly
+	if ( usb_state.configured && USB_running() )
+	{
+		usb_serial = true;
+		EnableUsbIRQ(); // a packet received meanwhile is still pending
+		return;
+	}
+	GpioToggle();
+	UsbSetup();
+	usb_serial = true;
+}
+//-----------------------------------------------------------------------------
+static void Api_flash_unlock(void)
+{
+	flash_unlock();
+}
+//-----------------------------------------------------------------------------
+static void Api_flash_lock(void)
+{
+	flash_lock();
+}
+//-----------------------------------------------------------------------------
+static void Api_flash_erase(uint32_t addr)
+{
+	Ramfunc_load();
+	flash_erase_page( (uint16_t*) (addr & ~(PAGE_SIZE-1)) );
+}
+//-----------------------------------------------------------------------------
+static void Api_flash_write(uint32_t addr, const uint16_t * data, int halfwords)
+{
+	Ramfunc_load();
+	flash_write_data( (uint16_t*) addr, (uint16_t*) data, halfwords);
+}
+
+//-----------------------------------------------------------------------------
+// the table, placed at BOOT_API_ADDR by the linker script
+//-----------------------------------------------------------------------------
+__attribute__((section(".boot_api"), used))
+const boot_api_t boot_api = {
+	.magic = BOOT_API_MAGIC,
+	.version = BOOT_API_VERSION,
+	.size = sizeof(boot_api_t),
+	.usb_begin = Api_usb_begin,
+	.usb_irq = NAME_OF_USB_IRQ_HANDLER,
+	.cdc_connected = Cdc_connected,
+	.cdc_available = Cdc_available,
+	.cdc_read = Cdc_read,
+	.cdc_write = Cdc_write,
+	.flash_unlock = Api_flash_unlock,
+	.flash_lock = Api_flash_lock,
+	.flash_erase = Api_flash_erase,
+	.flash_write = Api_flash_write,
+	.checksum = Calculate_CRC,
+	.stage_begin = Stage_begin,
+	.stage_write = Stage_write,
+	.stage_commit = Stage_commit,
+};
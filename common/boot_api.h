@@ -0,0 +1,75 @@
+/*
+ * boot_api.h
+ *
+ * Functions of the bootloader which can be called by the user program.
+ *
+ * The table is located at a fixed address, in the last 128 bytes of the
+ * bootloader flash area, directly below USER_PROGRAM. New entries are only
+ * appended, so a user program can use every entry below "size".
+ *
+ * The USB stack keeps its variables in a reserved RAM area (USBRAM in
+ * LinkerScript.ld), directly below the boot handoff block, its interrupt
+ * path runs from the RAMFUNC area below. The code is copied there by
+ * usb_begin() and the flash functions, if the bootloader has not done it
+ * before starting the user program. A user program
+ * calling the USB functions must keep the last BOOT_SHARED_RAM_SIZE bytes of
+ * the SRAM out of its own RAM, and its USB_LP_CAN_RX0 interrupt handler has
+ * to call usb_irq().
+ *
+ * In serial mode the data endpoint carries plain CDC data. A received packet
+ * stays in the endpoint buffer (the host gets NAK) till it has been read.
+ *
+ * Version 2: stage_begin, stage_write and stage_commit (Stage_xxx() of
+ * staging.h) to update the user program while it runs. These return
+ * STAGE_OK or one of STAGE_ERR_x.
+ */
+
+#ifndef BOOT_API_H
+#define BOOT_API_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define BOOT_API_MAGIC			0x49504142	// "BAPI"
+#define BOOT_API_VERSION		2
+#define BOOT_API_SIZE			0x80		// reserved at the end of the bootloader flash
+#define BOOT_API_ADDR			(USER_PROGRAM - BOOT_API_SIZE)
+#define BOOT_SHARED_RAM_SIZE	0x1300	// code in SRAM + USB stack RAM + boot handoff block
+
+typedef struct boot_api_t {
+	uint32_t magic;			// BOOT_API_MAGIC
+	uint16_t version;		// BOOT_API_VERSION
+	uint16_t size;			// sizeof(boot_api_t)
+	// USB CDC, serial mode
+	void (*usb_begin)(void);	// start USB, or continue with a device kept by the bootloader
+	void (*usb_irq)(void);		// USB interrupt handler
+	bool (*cdc_connected)(void);
+	int (*cdc_available)(void);
+	int (*cdc_read)(uint8_t * buf, int max);
+	int (*cdc_write)(const uint8_t * buf, int len); // up to 64 bytes, returns 0 if busy
+	// flash
+	void (*flash_unlock)(void);
+	void (*flash_lock)(void);
+	void (*flash_erase)(uint32_t addr);	// erase the page containing addr
+	void (*flash_write)(uint32_t addr, const uint16_t * data, int halfwords);
+	// image verification
+	int (*checksum)(uint8_t * buf, int len);	// upload protocol checksum
+	// version 2: staged update
+	int (*stage_begin)(uint32_t len);
+	int (*stage_write)(uint32_t offset, const uint8_t * data, int len);
+	int (*stage_commit)(uint32_t len, uint16_t checksum);	// then reset the MCU
+} boot_api_t;
+
+_Static_assert(sizeof(boot_api_t) <= BOOT_API_SIZE, "boot API table too large");
+
+#define BOOT_API				((const boot_api_t *)BOOT_API_ADDR)
+
+//-----------------------------------------------------------------------------
+// to be used by the user program
+//-----------------------------------------------------------------------------
+static inline bool Boot_api_valid(const boot_api_t * api)
+{
+	return api->magic == BOOT_API_MAGIC && api->version >= 1;
+}
+
+#endif // BOOT_API_H
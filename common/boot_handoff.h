@@ -0,0 +1,153 @@
+/*
+ * boot_handoff.h
+ *
+ * Information passed from the bootloader to the user program.
+ *
+ * The block lies in the last 256 bytes of the SRAM, which the bootloader
+ * keeps out of its own RAM (see LinkerScript.ld), so it is neither cleared
+ * nor overwritten by the stack. The user program has to read it before its
+ * own startup code clears the RAM, or reserve the area the same way.
+ *
+ * If (clocks & HANDOFF_CLOCKS_SET) is set, the bootloader has left the
+ * clock tree running from the PLL as given by sysclk_hz and rcc_cfgr, with
+ * the flash latency set accordingly. The user program may then skip its
+ * own clock setup. Otherwise the MCU still runs from HSI as after reset.
+ *
+ * Version 2: if (usb & HANDOFF_USB_KEPT) is set (bootloader built with
+ * USB_KEEP_ON_HANDOFF), the USB peripheral was left enumerated: clock on,
+ * D+/D- still connected, address and configuration set, buffer table and
+ * endpoint registers as listed. Only the USB interrupt is disabled in the
+ * NVIC, pending events are kept in USB_ISTR. A user program with the same
+ * CDC endpoint layout (EP0 control, EP1 bulk data, EP2 interrupt) can take
+ * over the peripheral without USB reset, the host does not re-enumerate.
+ *
+ * Version 3: verify_us, the time of the user program check, see image.h.
+ *
+ * Reboot request: the last 8 bytes of the block are not part of the handoff
+ * data. A user program which keeps the block out of its RAM can write a
+ * request there (Boot_request_set(BOOT_REQUEST)) and reset the MCU, the bootloader then
+ * stays active. This survives a system or watchdog reset, but no power
+ * cycle, for that the magic word in the backup register is still checked.
+ */
+
+#ifndef BOOT_HANDOFF_H
+#define BOOT_HANDOFF_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define BOOTLOADER_VERSION		0x0200		// major.minor
+
+#define BOOT_HANDOFF_MAGIC		0x4F484C42	// "BLHO"
+#define BOOT_HANDOFF_VERSION	3
+#define BOOT_HANDOFF_SIZE		0x100		// reserved at the end of the SRAM
+#define BOOT_HANDOFF_V1_SIZE	44			// sizeof(boot_handoff_t) of version 1
+#define BOOT_HANDOFF_ADDR		(SRAM_BASE + SRAM_SIZE - BOOT_HANDOFF_SIZE)
+
+#define BOOT_REQUEST_MAGIC		0x544F4F42	// "BOOT"
+#define BOOT_REQUEST_ADDR		(BOOT_HANDOFF_ADDR + BOOT_HANDOFF_SIZE - sizeof(boot_request_t))
+
+// boot reasons, more than one may be set
+#define BOOT_REASON_MAGIC		(1<<0)	// magic word in the backup register
+#define BOOT_REASON_PB2			(1<<1)	// BOOT 1 pin was high
+#define BOOT_REASON_NO_APP		(1<<2)	// no valid user program found
+#define BOOT_REASON_UPLOAD		(1<<3)	// a new user program was uploaded
+#define BOOT_REASON_STAGED		(1<<4)	// a staged image was installed, see staging.h
+#define BOOT_REASON_REQUEST		(1<<5)	// reboot request in the SRAM, see Boot_request_set()
+
+// clock state
+#define HANDOFF_CLOCKS_SET		(1<<0)	// HSE and PLL running, see rcc_cfgr
+
+// USB state
+#define HANDOFF_USB_KEPT		(1<<0)	// USB left configured, see USB_save_state()
+#define HANDOFF_USB_EPS			4		// number of saved endpoint registers
+
+typedef struct boot_handoff_t {
+	uint32_t magic;			// BOOT_HANDOFF_MAGIC
+	uint16_t version;		// BOOT_HANDOFF_VERSION
+	uint16_t size;			// sizeof(boot_handoff_t)
+	uint16_t bl_version;	// BOOTLOADER_VERSION
+	uint16_t boot_reason;	// BOOT_REASON_x, 0 or _STAGED if the user program was started directly
+	uint32_t reset_cause;	// RCC_CSR at reset, the flags are not cleared
+	uint32_t clocks;		// HANDOFF_CLOCKS_x
+	uint32_t sysclk_hz;		// core clock
+	uint32_t rcc_cfgr;		// RCC_CFGR as left by the bootloader (prescalers, PLL)
+	uint32_t boot_us;		// time from reset to the jump into the user program
+	uint32_t config_us;		// time from reset to SET_CONFIGURATION, 0 if not enumerated
+	uint16_t pages;			// number of pages written
+	uint16_t page_size;		// flash page size in bytes
+	// version 2
+	uint16_t usb;			// HANDOFF_USB_x
+	uint8_t usb_address;	// device address
+	uint8_t usb_config;		// selected configuration, 0 if not configured
+	uint16_t usb_btable;	// USB_BTABLE, offset of the buffer table in the packet memory
+	uint16_t usb_dtr_rts;	// last SET_CONTROL_LINE_STATE value
+	uint16_t usb_epr[HANDOFF_USB_EPS];	// USB_EPnR
+	uint8_t line_coding[7];	// last SET_LINE_CODING data (usb_cdc_line_coding)
+	uint8_t slot;			// slot the user program was started from, 0 = A, 1 = B (see staging.h)
+	// version 3
+	uint32_t verify_us;		// time of the user code check at boot (image.h)
+	uint32_t check;			// ~sum of all words above, always the last word
+} boot_handoff_t;
+
+typedef struct boot_request_t {
+	uint32_t magic;			// BOOT_REQUEST_MAGIC
+	uint32_t check;			// ~magic
+} boot_request_t;
+
+#define BOOT_REQUEST			((volatile boot_request_t *)BOOT_REQUEST_ADDR)
+
+_Static_assert(sizeof(boot_handoff_t) <= BOOT_HANDOFF_SIZE - sizeof(boot_request_t), "boot handoff block too large");
+
+// Newer versions append their fields before "check", which is always the
+// last word of the block. So the first part stays readable by older programs.
+//-----------------------------------------------------------------------------
+static inline uint32_t Boot_handoff_sum(const boot_handoff_t * h)
+{
+	const uint32_t * p = (const uint32_t *)h;
+	uint32_t sum = 0;
+	for (unsigned i = 0; i < (h->size/4u - 1); i++)
+		sum += p[i];
+	return ~sum;
+}
+//-----------------------------------------------------------------------------
+static inline void Boot_handoff_seal(boot_handoff_t * h)
+{
+	h->magic = BOOT_HANDOFF_MAGIC;
+	h->version = BOOT_HANDOFF_VERSION;
+	h->size = sizeof(boot_handoff_t);
+	h->bl_version = BOOTLOADER_VERSION;
+	h->check = Boot_handoff_sum(h);
+}
+//-----------------------------------------------------------------------------
+// to be used by the user program
+//-----------------------------------------------------------------------------
+static inline bool Boot_handoff_valid(const boot_handoff_t * h)
+{
+	if ( h->magic != BOOT_HANDOFF_MAGIC || h->version < 1 ||
+		 h->size < BOOT_HANDOFF_V1_SIZE || h->size > BOOT_HANDOFF_SIZE || (h->size & 3) )
+		return false;
+	return ((const uint32_t *)h)[h->size/4u - 1] == Boot_handoff_sum(h);
+}
+
+//-----------------------------------------------------------------------------
+static inline void Boot_request_set(volatile boot_request_t * r)
+{
+	r->magic = BOOT_REQUEST_MAGIC;
+	r->check = ~BOOT_REQUEST_MAGIC;
+}
+//-----------------------------------------------------------------------------
+// to be used by the bootloader. The RAM content after power-on is random,
+// the check word makes a false request unlikely.
+//-----------------------------------------------------------------------------
+static inline bool Boot_request_get_and_clear(volatile boot_request_t * r)
+{
+	if ( r->magic != BOOT_REQUEST_MAGIC )
+		return false;
+	r->magic = 0;
+	return r->check == (uint32_t)~BOOT_REQUEST_MAGIC;
+}
+
+extern boot_handoff_t boot_handoff;
+
+#endif // BOOT_HANDOFF_H
@@ -0,0 +1,67 @@
+/**
+ * @file common/dwt.h
+ * @brief Data watchpoint and trace unit, cycle counter only.
+ *
+ * The cycle counter runs with the core clock, so it wraps after
+ * about 59 seconds at 72 MHz.
+ */
+
+#ifndef _LIBMAPLE_DWT_H_
+#define _LIBMAPLE_DWT_H_
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+#include "libmaple_types.h"
+#include "util.h"
+
+/** DWT register map type (only the first two registers are used) */
+typedef struct dwt_reg_map {
+    __IO uint32 CTRL;           /**< Control register */
+    __IO uint32 CYCCNT;         /**< Cycle count register */
+} dwt_reg_map;
+
+/** DWT register map base pointer */
+#define DWT_REGS                        ((struct dwt_reg_map*)0xE0001000)
+
+/** Debug exception and monitor control register */
+#define DWT_DEMCR                       (*(__IO uint32*)0xE000EDFC)
+
+#define DWT_DEMCR_TRCENA                BIT(24)
+#define DWT_CTRL_CYCCNTENA              BIT(0)
+
+/**
+ * @brief Enable the trace block and start the cycle counter from 0.
+ */
+static inline void dwt_init(void) {
+    DWT_DEMCR |= DWT_DEMCR_TRCENA;
+    DWT_REGS->CYCCNT = 0;
+    DWT_REGS->CTRL |= DWT_CTRL_CYCCNTENA;
+}
+
+/**
+ * @brief Returns the current value of the cycle counter.
+ */
+static inline uint32 dwt_cycles(void) {
+    return DWT_REGS->CYCCNT;
+}
+
+/**
+ * @brief Busy wait for the given number of core clock cycles.
+ * The cycle counter must be running, see dwt_init().
+ */
+static inline void dwt_delay_cycles(uint32 cycles) {
+    uint32 start = DWT_REGS->CYCCNT;
+    while ((DWT_REGS->CYCCNT - start) < cycles)
+        ;
+}
+
+/** Busy wait for the given number of microseconds, the core runs at F_CPU */
+#define dwt_delay_us(us)                dwt_delay_cycles((us) * (F_CPU / 1000000))
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif
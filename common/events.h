@@ -0,0 +1,52 @@
+/*
+ * events.h
+ *
+ * Event flags raised by the interrupt handlers and handled by the main loop.
+ *
+ * The main loop sleeps with WFI while no event is pending. The flags are
+ * tested with the interrupts disabled, an interrupt becoming pending in
+ * between still ends the WFI, so no event is lost.
+ */
+
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include <stdint.h>
+
+#define EV_UPLOAD_DONE		(1<<0)	// all pages of the session are written
+#define EV_RUN				(1<<1)	// CMD_RUN acknowledged, start run_address
+#define EV_RESET			(1<<2)	// CMD_RESET acknowledged
+#define EV_ACTIVATE			(1<<3)	// CMD_RUN or CMD_RESET received, see Command_activate()
+
+extern volatile uint32_t main_events;
+
+//-----------------------------------------------------------------------------
+// set by an interrupt handler
+//-----------------------------------------------------------------------------
+static inline void Event_set(uint32_t ev)
+{
+	main_events |= ev;
+}
+//-----------------------------------------------------------------------------
+// sleep till an interrupt occurs, if no event is pending
+//-----------------------------------------------------------------------------
+static inline void Event_wait(void)
+{
+	asm volatile ("cpsid i" : : : "memory");
+	if ( main_events==0 )
+		asm volatile ("wfi");
+	asm volatile ("cpsie i" : : : "memory");
+}
+//-----------------------------------------------------------------------------
+// returns and clears the pending events of the given mask
+//-----------------------------------------------------------------------------
+static inline uint32_t Event_take(uint32_t mask)
+{
+	asm volatile ("cpsid i" : : : "memory");
+	uint32_t ev = main_events & mask;
+	main_events &= ~ev;
+	asm volatile ("cpsie i" : : : "memory");
+	return ev;
+}
+
+#endif // EVENTS_H
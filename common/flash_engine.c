@@ -0,0 +1,394 @@
+/*
+ * flash_engine.c
+ *
+ * Flash erase and programming driven by the end-of-operation interrupt,
+ * see flash_engine.h
+ */
+
+#include "usb_func.h"
+#include "flash_engine.h"
+#include "nvic.h"
+
+typedef struct flash_job_t {
+	uint32_t addr;
+	const uint16_t * src;	// data to write
+	uint16_t count;		// half-words to write, 0 = erase the page
+	uint16_t pos;		// next half-word
+	uint8_t slot;		// page copy the job was queued for, see Page_slot_of()
+#if FLASH_SECTORS
+	uint32_t end;		// erase: end of the sector range, 0 for a page, see Flash_queue_erase_range()
+#endif
+	uint16_t data[FLASH_JOB_BYTES/2];
+} flash_job_t;
+
+static flash_job_t jobs[FLASH_JOBS];
+static volatile uint8_t job_head;	// next free job
+static volatile uint8_t job_tail;	// oldest job, done when verified
+static flash_job_t * volatile job_run;	// job in progress, NULL if idle
+static volatile uint8_t erases_queued;	// erase jobs not yet done
+
+#if FLASH_RETRIES
+// retry of a job which failed the verify: erase the page, then rewrite it
+// from the page copy up to the end of the failed job
+static flash_job_t retry;
+static uint32_t retry_end;
+static uint8_t retries;
+#endif
+static uint32_t patch_end;	// last programmed half-word of a patched page, see Flash_queue_patch()
+
+// copy of the last two erased pages, reference of the verify and the retry
+static uint32_t page_copy[2][PAGE_SIZE/4] __attribute__((section(".noinit"))); // not cleared at reset
+static uint32_t page_addr[2];
+static uint8_t page_slot;	// slot of the last erased page
+
+uint32_t flash_errors;
+uint32_t flash_fail_addr;
+uint32_t flash_verify_cycles;
+uint16_t flash_retries;
+
+#define JOB_INDEX(i)		((i) & (FLASH_JOBS-1))
+#define PAGE_OF(addr)		((addr) & ~(PAGE_SIZE-1))
+
+//-----------------------------------------------------------------------------
+// slot of the newest copy of the page containing addr. Both slots hold the
+// same page when it was erased or patched again, the jobs queued before keep
+// the older slot.
+//-----------------------------------------------------------------------------
+static __ramfunc uint8_t Page_slot_of(uint32_t addr)
+{
+	return (page_addr[page_slot]==PAGE_OF(addr)) ? page_slot : (page_slot ^ 1);
+}
+//-----------------------------------------------------------------------------
+static __ramfunc uint8_t * Page_copy(uint8_t slot, uint32_t addr)
+{
+	return (uint8_t *)page_copy[slot] + (addr & (PAGE_SIZE-1));
+}
+//-----------------------------------------------------------------------------
+// read back [addr, end) with 32-bit loads, returns the first wrong address or 0
+//-----------------------------------------------------------------------------
+static __ramfunc uint32_t Verify(uint8_t slot, uint32_t addr, uint32_t end)
+{
+	const uint8_t * ref = Page_copy(slot, addr); // aligned like addr
+	if ( (addr & 2) && addr<end )
+	{
+		if ( *(volatile uint16_t *)addr != *(const uint16_t *)ref )
+			return addr;
+		addr += 2; ref += 2;
+	}
+	for (; addr+4 <= end; addr += 4, ref += 4)
+	{
+		uint32_t diff = *(volatile uint32_t *)addr ^ *(const uint32_t *)ref;
+		if ( diff )
+			return (diff & 0xFFFF) ? addr : (addr + 2);
+	}
+	if ( addr<end && *(volatile uint16_t *)addr != *(const uint16_t *)ref )
+		return addr;
+	return 0;
+}
+//-----------------------------------------------------------------------------
+// program the next half-word of the job. With FLASH_PROGRAM_X32 two
+// half-words at a word aligned address are programmed at once.
+//-----------------------------------------------------------------------------
+static __ramfunc void Program_next(flash_job_t * job)
+{
+	uint16_t pos = job->pos;
+	uint32_t addr = job->addr + pos*2;
+#if FLASH_PROGRAM_X32
+	if ( (addr & 2)==0 && pos+1 < job->count )
+	{
+		flash_program_word_start(addr, job->src[pos] | ((uint32_t)job->src[pos+1] << 16));
+		job->pos = pos + 2;
+		return;
+	}
+#endif
+	flash_program_start(addr, job->src[pos]);
+	job->pos = pos + 1;
+}
+//-----------------------------------------------------------------------------
+static __ramfunc void Job_start(flash_job_t * job)
+{
+	job_run = job;
+	if ( job->count==0 )
+	{
+		etrace(TR_ERASE_START, EP_DATA, (job->addr - upload_base) / PAGE_SIZE);
+		flash_erase_start(job->addr);
+	}
+	else
+	{
+		etrace(TR_WRITE_START, EP_DATA, job->count*2);
+		job->pos = 0;
+		Program_next(job);
+	}
+}
+//-----------------------------------------------------------------------------
+// start the job at job_tail, if not yet running
+//-----------------------------------------------------------------------------
+static __ramfunc void Engine_kick(void)
+{
+	if ( job_run || job_tail==job_head )
+		return;
+	Job_start(&jobs[JOB_INDEX(job_tail)]);
+}
+//-----------------------------------------------------------------------------
+// the verify of a written job failed at "bad", returns true if it is retried
+//-----------------------------------------------------------------------------
+static __ramfunc bool Retry_start(flash_job_t * job, uint32_t bad)
+{
+	etrace(TR_VERIFY_FAIL, EP_DATA, bad & (PAGE_SIZE-1));
+#if FLASH_RETRIES
+	if ( retries<FLASH_RETRIES )
+	{
+		retries++;
+		flash_retries++;
+		if ( job!=&retry )
+		{
+			retry_end = job->addr + job->count*2;
+			retry.slot = job->slot;
+		}
+		if ( PAGE_OF(bad)==PAGE_OF(patch_end-1) && retry_end < patch_end )
+			retry_end = patch_end; // the erase takes the rest of the patched page too
+		retry.addr = PAGE_OF(bad);
+		retry.count = 0; // erase first
+		Job_start(&retry);
+		return true;
+	}
+#else
+	(void)job;
+#endif
+	// give up, reported to the host with the next command
+	if ( flash_fail_addr==0 )
+		flash_fail_addr = bad;
+	flash_errors++;
+	return false;
+}
+//-----------------------------------------------------------------------------
+__ramfunc void FLASH_IRQHandler(void)
+{
+	// ends the operation. FLASH_ERR_x: the half-word was not written, this is found by the verify
+	if ( flash_poll()==FLASH_BUSY )
+		return;
+
+	flash_job_t * job = job_run;
+	if ( job==NULL )
+		return;
+
+	if ( job->count && job->pos < job->count )
+	{	// next half-word of the packet
+		Program_next(job);
+		return;
+	}
+	etrace( job->count ? TR_WRITE_END : TR_ERASE_END, EP_DATA, 0 );
+	job_run = NULL;
+
+	if ( job->count )
+	{	// read back the written half-words
+		uint32_t start = dwt_cycles();
+		uint32_t bad = Verify(job->slot, job->addr, job->addr + job->count*2);
+		flash_verify_cycles += dwt_cycles() - start;
+		if ( bad && Retry_start(job, bad) )
+			return;
+	}
+#if FLASH_RETRIES
+	else if ( job==&retry )
+	{	// page erased for the retry, rewrite it
+		retry.src = (const uint16_t *)Page_copy(retry.slot, retry.addr);
+		retry.count = (retry_end - retry.addr)/2;
+		Job_start(&retry);
+		return;
+	}
+#endif
+#if FLASH_SECTORS
+	else if ( job->end )
+	{	// next sector of the range
+		uint32_t next = flash_sector_start(flash_sector_of(job->addr) + 1);
+		if ( next < job->end )
+		{
+			job->addr = next;
+			Job_start(job);
+			return;
+		}
+	}
+#endif
+	else
+		erases_queued--;
+
+	// the job at job_tail is done
+#if FLASH_RETRIES
+	retries = 0;
+#endif
+	job_tail++;
+	OnFlashJobDone(); // may queue a held packet
+	Engine_kick();
+}
+
+//-----------------------------------------------------------------------------
+void Flash_engine_start(void)
+{
+	job_head = job_tail = 0;
+	job_run = NULL;
+	erases_queued = 0;
+#if FLASH_RETRIES
+	retries = 0;
+#endif
+	patch_end = 0;
+	flash_errors = 0;
+	flash_fail_addr = 0;
+	flash_verify_cycles = 0;
+	flash_retries = 0;
+	flash_unlock();
+	flash_await(); // clear the flags of an earlier operation
+	FLASH->CR |= FLASH_CR_EOPIE;
+	nvic_irq_enable(NVIC_FLASH);
+}
+//-----------------------------------------------------------------------------
+// the queue must be empty, see Flash_engine_idle()
+//-----------------------------------------------------------------------------
+void Flash_engine_stop(void)
+{
+	nvic_irq_disable(NVIC_FLASH);
+	FLASH->CR &= ~FLASH_CR_EOPIE;
+	flash_lock();
+}
+//-----------------------------------------------------------------------------
+// buffer of the next job, NULL if all jobs are in use
+//-----------------------------------------------------------------------------
+__ramfunc uint8_t * Flash_job_buffer(void)
+{
+	if ( (uint8_t)(job_head - job_tail) >= FLASH_JOBS )
+		return NULL;
+	return (uint8_t *)jobs[JOB_INDEX(job_head)].data;
+}
+//-----------------------------------------------------------------------------
+// write "bytes" from Flash_job_buffer() to addr, in one of the last two erased pages
+//-----------------------------------------------------------------------------
+__ramfunc void Flash_queue_write(uint32_t addr, int bytes)
+{
+	flash_job_t * job = &jobs[JOB_INDEX(job_head)];
+	if ( bytes & 1 )
+		((uint8_t *)job->data)[bytes] = 0xFF; // keep the erased value
+	job->addr = addr;
+	job->src = job->data;
+	job->count = (bytes+1)>>1;
+	if ( job->count==0 )
+		return;
+	job->slot = Page_slot_of(addr);
+	uint16_t * copy = (uint16_t *)Page_copy(job->slot, addr);
+	for (int i = 0; i < job->count; i++)
+		copy[i] = job->data[i];
+	job_head++;
+	Engine_kick();
+}
+//-----------------------------------------------------------------------------
+// take the page copy of the page before the last one for the page at addr
+//-----------------------------------------------------------------------------
+static __ramfunc void Page_slot_next(uint32_t addr)
+{
+	page_slot ^= 1;
+	page_addr[page_slot] = PAGE_OF(addr);
+}
+//-----------------------------------------------------------------------------
+static __ramfunc void Queue_erase_job(uint32_t addr)
+{
+	flash_job_t * job = &jobs[JOB_INDEX(job_head)];
+	job->addr = PAGE_OF(addr);
+	job->count = 0;
+#if FLASH_SECTORS
+	job->end = 0;
+#endif
+	erases_queued++;
+	job_head++;
+}
+//-----------------------------------------------------------------------------
+// erase the page containing addr, see Flash_can_erase()
+//-----------------------------------------------------------------------------
+__ramfunc void Flash_queue_erase(uint32_t addr)
+{
+	Page_slot_next(addr);
+	Queue_erase_job(addr);
+	patch_end = 0;
+	Engine_kick();
+}
+#if FLASH_SECTORS
+//-----------------------------------------------------------------------------
+// Erase the sectors of [addr, addr+len) ahead of the data, in one job, at the
+// start of a session. The first one from addr, as for a page, see
+// flash_erase_start(). The page erases queued later find their pages blank
+// and end at once. The job is not counted as a page erase, so the packets of
+// the first pages are received meanwhile, into the other job buffers.
+//-----------------------------------------------------------------------------
+__ramfunc void Flash_queue_erase_range(uint32_t addr, uint32_t len)
+{
+	flash_job_t * job = &jobs[JOB_INDEX(job_head)];
+	job->addr = PAGE_OF(addr);
+	job->count = 0;
+	job->end = addr + len;
+	job_head++;
+	Engine_kick();
+}
+#endif
+//-----------------------------------------------------------------------------
+// Read-modify-write of "bytes" from Flash_job_buffer() at addr, within one
+// page. The engine must be idle. The page is loaded into a page copy and the
+// patch merged. If all half-words to write are erased (0xFFFF), only these
+// are written. Otherwise the page is erased and written again from the copy,
+// up to its last programmed half-word. That is not possible with sectors,
+// returns false then.
+//-----------------------------------------------------------------------------
+__ramfunc bool Flash_queue_patch(uint32_t addr, int bytes)
+{
+	uint32_t page = PAGE_OF(addr);
+	uint32_t start = addr & ~1;
+	uint32_t end = (addr + bytes + 1) & ~1;
+
+	bool erase = false;
+	for (uint32_t a = start; a < end; a += 2)
+		if ( *(volatile uint16_t *)a != 0xFFFF )
+			erase = true;
+#if FLASH_SECTORS
+	if ( erase )
+		return false; // the sector erase would take the other pages too
+#endif
+
+	Page_slot_next(page);
+	uint32_t * copy = page_copy[page_slot];
+	for (int i = 0; i < PAGE_SIZE/4; i++)
+		copy[i] = ((volatile uint32_t *)page)[i];
+	const uint8_t * src = (const uint8_t *)jobs[JOB_INDEX(job_head)].data;
+	for (int i = 0; i < bytes; i++)
+		((uint8_t *)copy)[addr - page + i] = src[i];
+
+	// up to the last programmed half-word
+	patch_end = page + PAGE_SIZE;
+	while ( patch_end > page && ((uint16_t *)copy)[(patch_end - page)/2 - 1]==0xFFFF )
+		patch_end -= 2;
+	if ( erase )
+	{
+		Queue_erase_job(page);
+		start = page;
+		end = patch_end;
+	}
+	if ( end > start )
+	{
+		flash_job_t * job = &jobs[JOB_INDEX(job_head)];
+		job->addr = start;
+		job->slot = page_slot;
+		job->src = (const uint16_t *)Page_copy(page_slot, start);
+		job->count = (end - start)/2;
+		job_head++;
+	}
+	Engine_kick();
+	return true;
+}
+//-----------------------------------------------------------------------------
+// At most one erase waits in the queue. So the queued jobs belong to at most
+// two pages, each has its page copy.
+//-----------------------------------------------------------------------------
+__ramfunc bool Flash_can_erase(void)
+{
+	return erases_queued==0;
+}
+//-----------------------------------------------------------------------------
+__ramfunc bool Flash_engine_idle(void)
+{
+	return job_run==NULL && job_tail==job_head;
+}
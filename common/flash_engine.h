@@ -0,0 +1,65 @@
+/*
+ * flash_engine.h
+ *
+ * Flash erase and programming driven by the end-of-operation interrupt.
+ *
+ * The USB interrupt queues the jobs (page erase, or one received packet to
+ * write) and returns, the FLASH interrupt starts the next half-word or job
+ * at each EOP. So the CPU is free while the flash controller is busy.
+ * When all job buffers are in use, EP_DATA Rx stays on NAK and the held
+ * packet is taken when a job is done, see OnFlashJobDone().
+ *
+ * Jobs are executed in the order they were queued. The queue is accessed by
+ * the USB and the FLASH interrupt handlers, which have the same priority.
+ * Both run from SRAM (__ramfunc), an instruction fetch from the flash would
+ * stall till the erase or write is done.
+ *
+ * Each written job is read back with 32-bit loads and compared with a copy
+ * of its page in SRAM. On a mismatch the page is erased and rewritten from
+ * the copy, up to FLASH_RETRIES times, then the failing address is kept in
+ * flash_fail_addr. The read-back of a 64 byte packet takes about 16 loads,
+ * well below 0.1% of the ~1.7 ms to program it. The total is summed up in
+ * flash_verify_cycles, see CMD_STATS.
+ *
+ * F4 (FLASH_SECTORS): a page is the PAGE_SIZE view of the sector flash, the
+ * erase of a page erases its sector unless the rest of the sector is blank,
+ * see flash_erase_start(). A session erases its sectors ahead of the data,
+ * see Flash_queue_erase_range(). Aligned words are programmed with x32
+ * parallelism (FLASH_PROGRAM_X32). A failing page is not retried there.
+ */
+
+#ifndef FLASH_ENGINE_H
+#define FLASH_ENGINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define FLASH_JOBS			8			// power of 2
+#define FLASH_JOB_BYTES		EP_DATA_LEN	// one packet
+#if FLASH_SECTORS
+#define FLASH_RETRIES		0			// a sector can not be erased again without losing the pages written before
+#else
+#define FLASH_RETRIES		2			// erase and rewrite of a page failing the verify
+#endif
+
+extern uint32_t flash_errors; // number of jobs which failed the verify after all retries
+extern uint32_t flash_fail_addr; // first address read back wrong, 0 = none
+extern uint32_t flash_verify_cycles; // DWT cycles spent in the read-back
+extern uint16_t flash_retries; // number of page retries
+
+extern void Flash_engine_start(void);
+extern void Flash_engine_stop(void);
+extern uint8_t * Flash_job_buffer(void);
+extern void Flash_queue_write(uint32_t addr, int bytes);
+extern void Flash_queue_erase(uint32_t addr);
+extern bool Flash_queue_patch(uint32_t addr, int bytes);
+#if FLASH_SECTORS
+extern void Flash_queue_erase_range(uint32_t addr, uint32_t len);
+#endif
+extern bool Flash_can_erase(void);
+extern bool Flash_engine_idle(void);
+
+// called by the engine after each job, in the FLASH interrupt (usb_cmd.c)
+extern void OnFlashJobDone(void);
+
+#endif // FLASH_ENGINE_H
@@ -0,0 +1,100 @@
+/*
+ * image.c
+ *
+ * Trailer of the user program in slot A, see image.h
+ */
+
+#include "usb_func.h"
+#include "staging.h"
+#include "image.h"
+#include "crc.h"
+#include <stddef.h>
+
+//-----------------------------------------------------------------------------
+// plausibility check of the vector table at "addr": the initial stack pointer
+// lies in the SRAM and the reset vector in the flash
+//-----------------------------------------------------------------------------
+bool Check_user_code(uint32_t addr)
+{
+	uint32_t sp = *(volatile uint32_t *) addr;
+	uint32_t reset = *(volatile uint32_t *) (addr + 4);
+
+	return (sp > SRAM_BASE && sp <= SRAM_END) && (reset - FLASH_BASE) < FLASH_SIZE;
+}
+//-----------------------------------------------------------------------------
+// CRC of "len" bytes, the last word is filled up with the following flash bytes
+//-----------------------------------------------------------------------------
+uint32_t Image_crc(uint32_t addr, uint32_t len)
+{
+	crc_init();
+	uint32_t crc = crc_calc( (const uint32_t*) addr, (len+3)>>2 );
+	crc_deinit();
+	return crc;
+}
+//-----------------------------------------------------------------------------
+// erase the page of the trailer, before slot A gets written
+//-----------------------------------------------------------------------------
+void Image_invalidate(void)
+{
+	if ( IMAGE_TRAILER->magic == 0xFFFFFFFF )
+		return; // already erased
+	flash_erase_page( (uint16_t*) (IMAGE_TRAILER_ADDR & ~(PAGE_SIZE-1)) );
+	flash_wait_for_ready();
+	flash_lock();
+}
+//-----------------------------------------------------------------------------
+// write the trailer for a complete image in slot A
+//-----------------------------------------------------------------------------
+void Image_seal(uint32_t len, uint32_t version)
+{
+	image_trailer_t t = {
+		.magic = IMAGE_MAGIC,
+		.len = len,
+		.crc32 = Image_crc(SLOT_A_ADDR, len),
+		.version = version,
+	};
+	uint16_t * dst = (uint16_t*) IMAGE_TRAILER_ADDR;
+	flash_unlock();
+	flash_wait_for_ready();
+	// the magic word last, an interrupted write leaves no valid trailer
+	flash_write_data( dst + 2, ((uint16_t*) &t) + 2, (offsetof(image_trailer_t, verified) - 4)/2 );
+	flash_write_data( dst, (uint16_t*) &t.magic, 2 );
+	flash_lock();
+}
+//-----------------------------------------------------------------------------
+// the fast part of the check, a few words: no trailer, or the image was
+// checked at a previous boot and nothing was erased since
+//-----------------------------------------------------------------------------
+bool Image_checked(void)
+{
+	const image_trailer_t * t = IMAGE_TRAILER;
+	if ( t->magic != IMAGE_MAGIC )
+		return true; // no trailer, see image.h
+	return t->len != 0 && t->len <= SLOT_A_MAX_LEN &&
+		   t->verified == t->crc32 && t->verified != 0xFFFFFFFF;
+}
+//-----------------------------------------------------------------------------
+// check slot A against its trailer. The length is limited to the slot, so a
+// corrupted trailer can not extend the check.
+//-----------------------------------------------------------------------------
+bool Image_valid(void)
+{
+	const image_trailer_t * t = IMAGE_TRAILER;
+	if ( Image_checked() )
+		return true;
+	if ( t->len == 0 || t->len > SLOT_A_MAX_LEN )
+		return false;
+	if ( Image_crc(SLOT_A_ADDR, t->len) != t->crc32 )
+		return false;
+
+	// remember the result, if the word is still erased
+	if ( t->verified != 0xFFFFFFFF )
+		return true;
+	uint32_t crc = t->crc32;
+	Ramfunc_load(); // on the way to the user program, see boot.c
+	flash_unlock();
+	flash_wait_for_ready();
+	flash_write_data( (uint16_t*) &t->verified, (uint16_t*) &crc, 2 );
+	flash_lock();
+	return true;
+}
@@ -0,0 +1,46 @@
+/*
+ * image.h
+ *
+ * Trailer of the user program in slot A, checked at each boot.
+ *
+ * The trailer lies in the last 20 bytes of slot A (see staging.h), which an
+ * image can never reach. The bootloader writes it after an upload or an
+ * install is complete and verified, the magic word last. A slot A without
+ * trailer (e.g. written by SWD) is accepted as before, if its vector table
+ * is plausible (Check_user_code). With a trailer exactly "len" bytes are checked with
+ * the CRC unit, the time needed is reported in boot_handoff.verify_us.
+ *
+ * After the first successful check the CRC is written into "verified" as
+ * well, the following boots only compare the two words (Image_checked(), on
+ * HSI). The full check of the first boot runs after the clock setup. Any erase of the
+ * trailer page, also the one before each write of slot A, clears the mark,
+ * so the first boot after an upload always checks the whole image.
+ */
+
+#ifndef IMAGE_H
+#define IMAGE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define IMAGE_MAGIC			0x474D4942	// "BIMG"
+#define IMAGE_TRAILER_ADDR	(SLOT_A_ADDR + SLOT_A_SIZE - sizeof(image_trailer_t))
+
+typedef struct image_trailer_t {
+	uint32_t magic;			// IMAGE_MAGIC, written last
+	uint32_t len;			// image length in bytes
+	uint32_t crc32;			// CRC unit over (len+3)/4 words
+	uint32_t version;		// given by the uploader (CMD_SESSION data_len), 0 if unknown
+	uint32_t verified;		// == crc32 once checked at boot, erased before
+} image_trailer_t;
+
+#define IMAGE_TRAILER		((const image_trailer_t *)IMAGE_TRAILER_ADDR)
+
+extern bool Check_user_code(uint32_t addr);
+extern uint32_t Image_crc(uint32_t addr, uint32_t len);
+extern void Image_invalidate(void);
+extern void Image_seal(uint32_t len, uint32_t version);
+extern bool Image_checked(void);
+extern bool Image_valid(void);
+
+#endif // IMAGE_H
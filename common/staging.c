@@ -0,0 +1,196 @@
+/*
+ * staging.c
+ *
+ * Update of the user program while it is running and A/B slots, see staging.h
+ *
+ * The functions keep no state in RAM: they are called by the user program,
+ * which owns the RAM of the bootloader. The page to write into is erased
+ * when the write reaches its first byte, so the image has to be written in
+ * ascending order.
+ */
+
+#include "usb_func.h"
+#include "staging.h"
+#include "image.h"
+
+_Static_assert((STAGING_SIZE % PAGE_SIZE) == 0, "staging region must consist of whole pages");
+_Static_assert(STAGING_ADDR >= USER_PROGRAM + PAGE_SIZE, "staging region too large");
+
+#define STAGING_INFO		((const staging_info_t *)STAGING_INFO_ADDR)
+
+//-----------------------------------------------------------------------------
+static void Erase_page(uint32_t addr)
+{
+	flash_erase_page( (uint16_t*) addr );
+	flash_wait_for_ready();
+}
+//-----------------------------------------------------------------------------
+// clear the magic word of slot B, programming 0 over a written half-word is allowed.
+// Returns the flash error flags.
+//-----------------------------------------------------------------------------
+static uint32_t Slot_b_drop(void)
+{
+	uint16_t zero[2] = {0, 0};
+	flash_unlock();
+	flash_wait_for_ready();
+	uint32_t err = flash_write_data( (uint16_t*) &STAGING_INFO->magic, zero, 2 );
+	flash_lock();
+	return err;
+}
+
+//-----------------------------------------------------------------------------
+// the slot to start
+//-----------------------------------------------------------------------------
+uint32_t Slot_active(void)
+{
+#if BOOT_SLOT_SWAP
+	return SLOT_A_ADDR;
+#else
+	// the image was checked when activated, the magic word is sufficient here
+	return (STAGING_INFO->magic == STAGING_MAGIC) ? SLOT_B_ADDR : SLOT_A_ADDR;
+#endif
+}
+//-----------------------------------------------------------------------------
+// the slot to write a new image into
+//-----------------------------------------------------------------------------
+uint32_t Slot_inactive(void)
+{
+	return (Slot_active()==SLOT_A_ADDR) ? SLOT_B_ADDR : SLOT_A_ADDR;
+}
+//-----------------------------------------------------------------------------
+// checked by the USB interrupt for each page, see OnCommand()
+//-----------------------------------------------------------------------------
+__ramfunc uint32_t Slot_max_len(uint32_t slot)
+{
+	return (slot==SLOT_B_ADDR) ? STAGING_MAX_LEN : SLOT_A_MAX_LEN;
+}
+//-----------------------------------------------------------------------------
+// make a completely written slot the active one, with one flash write.
+// The info block of slot B must be erased, see Stage_begin(). An image
+// in slot A may reach up to IN_PLACE_MAX_LEN, without trailer then.
+//-----------------------------------------------------------------------------
+int Slot_activate(uint32_t slot, uint32_t len, uint16_t checksum, uint16_t version)
+{
+	Ramfunc_load(); // also called by the user program, see boot_api.h
+	if ( len==0 || len>((slot==SLOT_A_ADDR) ? IN_PLACE_MAX_LEN : Slot_max_len(slot)) )
+		return STAGE_ERR_SIZE;
+	if ( (uint16_t)Calculate_CRC( (uint8_t*) slot, len ) != checksum )
+		return STAGE_ERR_CHECKSUM;
+
+	if ( slot==SLOT_A_ADDR )
+	{	// back to slot A
+		if ( len<=Slot_max_len(slot) )
+			Image_seal(len, version);
+		if ( STAGING_INFO->magic == STAGING_MAGIC && Slot_b_drop() )
+			return STAGE_ERR_FLASH;
+		return STAGE_OK;
+	}
+	staging_info_t info = { .len = len, .checksum = checksum, .version = version, .magic = STAGING_MAGIC };
+	flash_unlock();
+	flash_wait_for_ready();
+	uint32_t err = flash_write_data( (uint16_t*) STAGING_INFO_ADDR, (uint16_t*) &info, sizeof(info)/2 );
+	flash_lock();
+	return err ? STAGE_ERR_FLASH : STAGE_OK;
+}
+
+//-----------------------------------------------------------------------------
+// prepare the inactive slot for an image of "len" bytes.
+// For slot B the page holding the info block is erased, this drops a pending image.
+//-----------------------------------------------------------------------------
+int Stage_begin(uint32_t len)
+{
+	Ramfunc_load();
+	uint32_t slot = Slot_inactive();
+	if ( len==0 || len>Slot_max_len(slot) )
+		return STAGE_ERR_SIZE;
+
+	if ( slot==SLOT_B_ADDR )
+		Erase_page(STAGING_INFO_ADDR & ~(PAGE_SIZE-1));
+	else
+		Image_invalidate();
+	flash_lock();
+	return STAGE_OK;
+}
+//-----------------------------------------------------------------------------
+// write "len" bytes of the image at "offset", which must be even.
+// An odd length is only allowed for the last chunk.
+//-----------------------------------------------------------------------------
+int Stage_write(uint32_t offset, const uint8_t * data, int len)
+{
+	Ramfunc_load();
+	uint32_t slot = Slot_inactive();
+	if ( (offset & 1) || len<0 || (offset + len) > Slot_max_len(slot) )
+		return STAGE_ERR_OFFSET;
+
+	flash_unlock();
+	while ( len>0 )
+	{
+		uint32_t addr = slot + offset;
+		if ( (addr & (PAGE_SIZE-1))==0 )
+			Erase_page(addr);
+
+		// up to the end of the current page
+		int n = PAGE_SIZE - (addr & (PAGE_SIZE-1));
+		if ( n>len ) n = len;
+
+		flash_write_data( (uint16_t*) addr, (uint16_t*) data, n>>1 );
+		if ( n & 1 )
+		{	// last byte, fill up with the erased value
+			uint16_t last = 0xFF00 | data[n-1];
+			flash_write_data( (uint16_t*) (addr + n - 1), &last, 1 );
+		}
+		offset += n;
+		data += n;
+		len -= n;
+	}
+	flash_lock();
+	return STAGE_OK;
+}
+//-----------------------------------------------------------------------------
+// check the staged image and activate it. With BOOT_SLOT_SWAP it is
+// installed at the next reset, otherwise started from its slot.
+//-----------------------------------------------------------------------------
+int Stage_commit(uint32_t len, uint16_t checksum)
+{
+	return Slot_activate(Slot_inactive(), len, checksum, 0);
+}
+
+//-----------------------------------------------------------------------------
+// Called by the bootloader directly after reset (on HSI) and after an upload.
+// With BOOT_SLOT_SWAP an activated slot B is copied to slot A,
+// returns BOOT_REASON_STAGED if done.
+//-----------------------------------------------------------------------------
+uint16_t Stage_install(void)
+{
+#if BOOT_SLOT_SWAP
+	const staging_info_t * info = STAGING_INFO;
+	if ( info->magic != STAGING_MAGIC )
+		return 0;
+
+	uint32_t len = info->len;
+	uint16_t checksum = info->checksum;
+	if ( len==0 || len>STAGING_MAX_LEN ||
+		 (uint16_t)Calculate_CRC( (uint8_t*) SLOT_B_ADDR, len ) != checksum )
+		return 0;
+
+	Ramfunc_load(); // the flash routines, not copied on the way to the user program
+	Image_invalidate();
+	for (uint32_t offset = 0; offset < len; offset += PAGE_SIZE)
+	{
+		uint32_t n = len - offset;
+		if ( n>PAGE_SIZE ) n = PAGE_SIZE;
+		Erase_page(SLOT_A_ADDR + offset);
+		flash_write_data( (uint16_t*) (SLOT_A_ADDR + offset), (uint16_t*) (SLOT_B_ADDR + offset), (n+1)>>1 );
+	}
+	flash_lock();
+
+	// if the copy failed, the record stays valid and the copy is repeated
+	if ( (uint16_t)Calculate_CRC( (uint8_t*) SLOT_A_ADDR, len ) != checksum )
+		return 0;
+	Image_seal(len, info->version);
+	Slot_b_drop();
+	return BOOT_REASON_STAGED;
+#else
+	return 0; // the slots are executed in place
+#endif
+}
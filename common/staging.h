@@ -0,0 +1,83 @@
+/*
+ * staging.h
+ *
+ * Update of the user program while it is running.
+ *
+ * The user program receives the new image by its own means (e.g. over the
+ * CDC serial mode of the boot API) and writes it with Stage_write() into the
+ * staging region, the upper part of the user flash. Stage_commit() checks the
+ * image and marks it as pending, the user program then resets the MCU.
+ * Directly after reset the bootloader copies the image to USER_PROGRAM and
+ * starts it, without USB and without user interaction.
+ *
+ * A user program using this service must be linked into the flash below
+ * STAGING_ADDR. The info block (staging_info_t) is written into the last
+ * bytes of the staging region, its magic word last. If the copy is
+ * interrupted, it is repeated at the next reset.
+ *
+ * A/B slots: slot A is USER_PROGRAM, slot B the staging region. Uploads over
+ * USB and the Stage_xxx() functions always write into the inactive slot, the
+ * active one stays untouched till the new image is complete and checked.
+ * The info block of slot B is the activation record: writing its magic word
+ * activates B, clearing it (programming 0, one flash write) activates A.
+ * - BOOT_SLOT_SWAP 1: user programs are linked for USER_PROGRAM. Slot B is
+ *   always the inactive one, an activated image is copied to slot A (right
+ *   after the upload or at the next reset) and the record is cleared.
+ *   A USB upload too large for slot B is written in place (IN_PLACE_MAX_LEN),
+ *   the running program is lost if that upload is interrupted.
+ * - BOOT_SLOT_SWAP 0: both slots are executed in place, a user program has
+ *   to be linked for the slot it is uploaded to (see Slot_inactive()).
+ */
+
+#ifndef STAGING_H
+#define STAGING_H
+
+#include <stdint.h>
+
+#define STAGING_MAGIC		0x47545342	// "BSTG"
+#define STAGING_ADDR		(FLASH_BASE + FLASH_SIZE - STAGING_SIZE)
+#define STAGING_INFO_ADDR	(STAGING_ADDR + STAGING_SIZE - sizeof(staging_info_t))
+#define STAGING_MAX_LEN		(STAGING_SIZE - sizeof(staging_info_t))
+
+#define SLOT_A_ADDR			USER_PROGRAM
+#define SLOT_A_SIZE			(STAGING_ADDR - USER_PROGRAM)
+#define SLOT_B_ADDR			STAGING_ADDR
+#define SLOT_A_MAX_LEN		(SLOT_A_SIZE - sizeof(image_trailer_t)) // see image.h
+
+// first address of the flash erased with the activation record
+#if FLASH_SECTORS
+#define RECORD_ERASE_ADDR	STAGING_ADDR // the last sector
+#else
+#define RECORD_ERASE_ADDR	(STAGING_INFO_ADDR & ~(PAGE_SIZE-1))
+#endif
+// an upload too large for slot B is written in place from USER_PROGRAM,
+// up to the activation record. Beyond slot A it gets no trailer (image.h).
+#define IN_PLACE_MAX_LEN	(RECORD_ERASE_ADDR - USER_PROGRAM)
+
+typedef struct staging_info_t {
+	uint32_t len;			// image length in bytes
+	uint16_t checksum;		// Calculate_CRC() of the image
+	uint16_t version;		// image version, see image.h
+	uint32_t magic;			// STAGING_MAGIC, written last
+} staging_info_t;
+
+// return values of the Stage_xxx() functions
+enum {
+	STAGE_OK = 0,
+	STAGE_ERR_SIZE,		// image too large for the staging region
+	STAGE_ERR_OFFSET,	// odd offset or out of the image
+	STAGE_ERR_CHECKSUM,	// staged data does not match the checksum
+	STAGE_ERR_FLASH,	// the activation record could not be written
+};
+
+extern uint32_t Slot_active(void);
+extern uint32_t Slot_inactive(void);
+extern uint32_t Slot_max_len(uint32_t slot);
+extern int Slot_activate(uint32_t slot, uint32_t len, uint16_t checksum, uint16_t version);
+
+extern int Stage_begin(uint32_t len);
+extern int Stage_write(uint32_t offset, const uint8_t * data, int len);
+extern int Stage_commit(uint32_t len, uint16_t checksum);
+extern uint16_t Stage_install(void);
+
+#endif // STAGING_H
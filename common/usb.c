@@ -0,0 +1,454 @@
+/*
+ * usb.c
+ *
+ *  Created on: Apr 25, 2020
+ *      Author: stevestrong
+ */
+// Use USB as virtual COM Port
+// Common USB FS device driver for F1 and F3, the family specific register
+// access is defined in usb_traits.h of each project. The control requests
+// are handled in usb_ctrl.c, the upload protocol on EP_DATA in usb_cmd.c.
+// F4 uses the OTG FS core instead (USB_OTG), see usb_otg.c of that project.
+// tools/host_test builds it for the host against a mock of the registers.
+
+#include <stddef.h>
+#include <string.h>
+#include "usb_std.h"
+#include "usb_func.h"
+
+#if !USB_OTG
+
+#include "usb_desc.h"
+#include "usb_ep.h"
+#include "usb_cmd.h"
+
+
+//-----------------------------------------------------------------------------
+// Packet memory (PMA): a 16 bit word of the buffers is a UMEM_FAKEWIDTH word
+// in the address space, 32 bit (1 x 16 bit per word, UMEM_SHIFT 1) or 16 bit
+// (2 x 16 bit per word, UMEM_SHIFT 0), see usb_traits.h.
+// The buffer addresses are taken from the EP table, which is in the PMA too.
+// So the interrupt path (__ramfunc) reads no table from the flash.
+//-----------------------------------------------------------------------------
+typedef volatile UMEM_FAKEWIDTH pma_word_t;
+
+#define EP_TX_BUF(ep)	((pma_word_t *)PMA_ADDR(EpTable[ep].txOffset & 0xFFFE))
+#define EP_RX_BUF(ep)	((pma_word_t *)PMA_ADDR(EpTable[ep].rxOffset & 0xFFFE))
+
+_Static_assert(EP_TABLE_OFFSET >= EP_COMM_RX_OFFSET + EP_INT_MAX_LEN, "EP table overlaps the EP buffers");
+
+//-----------------------------------------------------------------------------
+// helper routines
+//-----------------------------------------------------------------------------
+// an IN endpoint (bit 7 set) is stalled on the TX side, an OUT endpoint on the RX side
+//-----------------------------------------------------------------------------
+void Stall_EPAddr(int epNum)
+{
+	trace("stall\n");
+	etrace(TR_STALL, epNum, 0);
+
+	if ( epNum & 0x80 ) // IN EP
+		EpSetStatTx(epNum & 0x7F, USB_EP_TX_STALL);
+	else
+		EpSetStatRx(epNum, USB_EP_RX_STALL);
+}
+//-----------------------------------------------------------------------------
+void UnStall_EPAddr(int epNum)
+{
+	trace("unstall\n");
+	etrace(TR_UNSTALL, epNum, 0);
+
+	if ( epNum & 0x80 ) // IN EP
+		EpSetStatTx(epNum & 0x7F, USB_EP_TX_NAK);
+	else
+		EpSetStatRx(epNum, USB_EP_RX_VALID);
+}
+
+//-----------------------------------------------------------------------------
+void Stall(int ep)
+{
+	Stall_EPAddr(USB_EP_ADDR_OUT(ep));
+	Stall_EPAddr(USB_EP_ADDR_IN(ep));
+}
+//-----------------------------------------------------------------------------
+void UnStall(int ep)
+{
+	UnStall_EPAddr(USB_EP_ADDR_OUT(ep));
+	UnStall_EPAddr(USB_EP_ADDR_IN(ep));
+}
+
+//-----------------------------------------------------------------------------
+// mark EP ready to receive, set STAT_RX to VALID
+//-----------------------------------------------------------------------------
+__ramfunc void MarkBufferRxDone(int ep)
+{
+	strace("clrBuf logEpNum=%i\n", ep);
+	EpSetStatRx(ep, USB_EP_RX_VALID);
+}
+
+//-----------------------------------------------------------------------------
+// mark EP ready to transmit, set STAT_TX to VALID
+//-----------------------------------------------------------------------------
+__ramfunc void MarkBufferTxReady(int ep)
+{
+	strace("validateBuf logEpNum=%i\n", ep);
+	EpSetStatTx(ep, USB_EP_TX_VALID);
+}
+
+#if USB_FRAME_STATS
+//-----------------------------------------------------------------------------
+// Frame statistics, read by the host with CMD_STATS.
+// The packets and bytes on EP_DATA are summed up for each frame and evaluated
+// on the next SOF. Frames without EP_DATA traffic during an upload mean that
+// the host was NAKed or had nothing to send.
+//-----------------------------------------------------------------------------
+usb_stats_t usb_stats;
+uint16_t frame_nr, frame_bytes, frame_packets;
+bool frame_sync;
+
+__ramfunc void CountPacket(uint16_t len)
+{
+	frame_packets++;
+	frame_bytes += len;
+}
+//-----------------------------------------------------------------------------
+void ResetFrameStats(void)
+{
+	uint32_t config_us = usb_stats.config_us; // measured once after power-on
+	memset(&usb_stats, 0, sizeof(usb_stats));
+	usb_stats.config_us = config_us;
+	frame_packets = 0;
+	frame_bytes = 0;
+	frame_sync = false;
+}
+//-----------------------------------------------------------------------------
+__ramfunc void OnSof(void)
+{
+	uint16_t fn = USB_FNR & USB_FNR_FN;
+	// more than one frame has elapsed if the SOF IRQ was blocked, e.g. by a page erase
+	uint16_t elapsed = (fn - frame_nr) & USB_FNR_FN;
+	frame_nr = fn;
+	if ( !frame_sync )
+	{	// first SOF after reset, only synchronize the frame number
+		frame_sync = true;
+		return;
+	}
+	usb_stats.frames += elapsed;
+
+	if (frame_packets)
+	{
+		usb_stats.data_frames++;
+		usb_stats.bytes += frame_bytes;
+		if (frame_bytes > usb_stats.max_frame_bytes)
+			usb_stats.max_frame_bytes = frame_bytes;
+		usb_stats.hist[(frame_packets < USB_STATS_HIST) ? frame_packets : (USB_STATS_HIST-1)]++;
+		etrace(TR_FRAME, EP_DATA, frame_bytes);
+		elapsed--;
+	}
+	if ( num_pages>0 && crt_page<num_pages )
+	{	// upload in progress, but no data moved
+		usb_stats.idle_frames += elapsed;
+		usb_stats.hist[0] += elapsed;
+	}
+	frame_packets = 0;
+	frame_bytes = 0;
+}
+#endif
+
+//-----------------------------------------------------------------------------
+// initialize the EPs
+//-----------------------------------------------------------------------------
+void InitEndpoints(void)
+{
+	trace("InitEPs\n");
+	USB_CNTR = 1;          // Reset and clear Ints
+	CMD.configuration = 0;
+	CMD.transferLen = 0;   // no transfers
+	CMD.packetLen = 0;
+	CMD.transferPtr = 0;
+	USB_CNTR = 0;          // release reset
+	usb_state.suspended = false;
+	usb_state.configured = false;
+
+	// EP0 ist always reserved for control
+	// the other endpoints must match the numbers written in the descriptors
+	// see usb_desc.c: EP_DATA_IN, EP_DATA_OUT, EP_COMM_IN
+
+	// EP0 = Control, IN und OUT
+	EpTable[EP_CTRL].txOffset = EP_CTRL_TX_OFFSET;
+	EpTable[EP_CTRL].txCount = 0;
+	EpTable[EP_CTRL].rxOffset = EP_CTRL_RX_OFFSET;
+	EpTable[EP_CTRL].rxCount = EP_RX_LEN_ID;
+
+	// EP1 = Bulk IN and OUT
+	EpTable[EP_DATA].txOffset = EP_DATA_TX_OFFSET;
+	EpTable[EP_DATA].txCount = 0;
+	EpTable[EP_DATA].rxOffset = EP_DATA_RX_OFFSET;
+	EpTable[EP_DATA].rxCount = EP_RX_LEN_ID;
+
+	// EP2 = Int IN and OUT
+	EpTable[EP_COMM].txOffset = EP_COMM_TX_OFFSET;
+	EpTable[EP_COMM].txCount = 0;
+	EpTable[EP_COMM].rxOffset = EP_COMM_RX_OFFSET;
+	EpTable[EP_COMM].rxCount = EP_RX_LEN_ID;
+
+	USB_BTABLE = EP_TABLE_OFFSET; // the table start offset from the USB RAM
+
+	// CTRL EP
+	USB_EP0R =			// EP0 = Control, IN and OUT
+		(3 << 12) |		// STAT_RX = 3, Rx enabled
+		(2 << 4) |		// STAT_TX = 2, NAK
+		(1 << 9) |		// EP_TYPE = 1, Control
+		EP_CTRL;
+	// DATA EP
+	USB_EP1R =			// EP1 = Bulk IN and OUT
+		(3 << 12) |		// STAT_RX = 3, Rx enabled
+		(2 << 4) |		// STAT_TX = 2, NAK
+		(0 << 9) |		// EP_TYPE = 0, Bulk
+		EP_DATA;
+	// COMM EP
+	USB_EP2R =			// EP2 = Int, IN und OUT
+		(3 << 12) |		// STAT_RX = 3, Rx enabled
+		(2 << 4) |		// STAT_TX = 2, NAK
+		(3 << 9) |		// EP_TYPE = 3, INT
+		EP_COMM;
+
+	USB_ISTR = 0;          // clear pending Interrupts
+	USB_CNTR =
+		USB_CNTR_CTRM |             // Irq by ACKed Pakets
+		USB_CNTR_RESETM |           // Irq by Reset
+		USB_CNTR_SUSPM | USB_CNTR_WKUPM;
+
+#if USB_FRAME_STATS
+	ResetFrameStats();
+	USB_CNTR |= USB_CNTR_SOFM | USB_CNTR_ESOFM;
+#endif
+
+	USB_SetAddress(0);
+}
+
+//-----------------------------------------------------------------------------
+// reads up to a given number of even bytes from control EP receive buffer
+//-----------------------------------------------------------------------------
+__ramfunc void Read_PMA(uint8_t* dest, const pma_word_t * src, int count)
+{
+	trace("rx="); ntrace(count, 0); trace("-");
+
+	if (!count) return;
+
+	if (count > EP_DATA_LEN)
+		count = EP_DATA_LEN;
+
+	int i = count/2;
+	while (i--)
+	{
+		UMEM_FAKEWIDTH val = *src++;
+		*dest++ = val;
+		*dest++ = val>>8;
+	}
+	if (count&1) { // read last odd byte if any
+		UMEM_FAKEWIDTH val = *src;
+		*dest = val;
+	}
+}
+//-----------------------------------------------------------------------------
+// number of bytes received on the EP
+//-----------------------------------------------------------------------------
+__ramfunc uint16_t Ep_rx_count(int ep)
+{
+	return EpTable[ep].rxCount & 0x3FF;
+}
+//-----------------------------------------------------------------------------
+// reads up to a given number of even bytes from control EP receive buffer
+//-----------------------------------------------------------------------------
+__ramfunc void ReadData(int ep, uint8_t* dest, int count)
+{
+	int rd = Ep_rx_count(ep);
+	if (count>rd)
+		count = rd;
+	etrace(TR_RX, ep, count);
+	Read_PMA(dest, EP_RX_BUF(ep), count);
+	if (ep==EP_CTRL)
+		MarkBufferRxDone(EP_CTRL); // release EP0 Rx
+}
+//-----------------------------------------------------------------------------
+// writes up to 64 bytes into the specified EP transmit buffer
+//-----------------------------------------------------------------------------
+__ramfunc int SendData(int ep, uint8_t * src, int count)
+{
+	trace("tx="); ntrace(count, 0);
+
+	if (count > EP_DATA_LEN)
+		count = EP_DATA_LEN;
+	etrace(TR_TX, ep, count);
+
+	EpTable[ep].txCount = count;
+	if (count)
+	{
+		pma_word_t * dest = EP_TX_BUF(ep);
+		int j = count/2;
+		while (j--)
+		{
+		    register UMEM_FAKEWIDTH val = *src++;
+		    val |= (*src++) << 8;
+		    *dest++ = val;
+		}
+		if (count&1) // send last odd byte if any
+		{
+		    register UMEM_FAKEWIDTH val = *src;
+		    *dest = val;
+		}
+	}
+	MarkBufferTxReady(ep); // mark Tx buffer ready to be sent
+	return count;
+}
+
+//-----------------------------------------------------------------------------
+//--------------- USB-Interrupt-Handler ---------------------------------------
+// The handler and the data endpoint path are executed from SRAM (__ramfunc),
+// so packets are served while the flash is erased or written. The control
+// requests (OnSetup) still run from flash, they are not expected then.
+//-----------------------------------------------------------------------------
+__ramfunc void NAME_OF_USB_IRQ_HANDLER(void)
+{
+    uint32_t irqStatus = USB_ISTR; // Interrupt-Status
+
+	if (irqStatus & USB_ISTR_WKUP) // Suspend-->Resume
+	{
+		trace("WKUP\n");
+		etrace(TR_WAKEUP, 0, 0);
+		USB_CNTR &= ~(USB_CNTR_FSUSP | USB_CNTR_LPMODE);
+		usb_state.suspended = false;
+	}
+	else if (irqStatus & USB_ISTR_SUSP) // after 3 ms break -->Suspend
+	{
+		trace("SUSP\n");
+		etrace(TR_SUSPEND, 0, 0);
+		usb_state.suspended = true;
+		USB_CNTR |= (USB_CNTR_FSUSP | USB_CNTR_LPMODE);
+	}
+
+	// clear here the other interrupt bits
+	USB_ISTR = ~(USB_ISTR_PMAOVR|USB_ISTR_ERR|USB_ISTR_WKUP|USB_ISTR_SUSP|USB_ISTR_RESET|USB_ISTR_SOF|USB_ISTR_ESOF); // clear diverse IRQ bits
+
+#if USB_FRAME_STATS
+	if (irqStatus & USB_ISTR_ESOF) // expected SOF is missing
+		usb_stats.missed_sofs++;
+	if (irqStatus & USB_ISTR_SOF)
+		OnSof();
+#endif
+
+	if (irqStatus & USB_ISTR_RESET) // Bus Reset
+	{
+		trace("RESET\n");
+		etrace(TR_RESET, 0, 0);
+		CMD.configuration = 0;
+		InitEndpoints();
+	}
+	else
+	{	// Endpoint Interrupts
+		while ( (irqStatus = USB_ISTR) & USB_ISTR_CTR )
+		{
+			USB_ISTR = (usb_reg_t) ~USB_ISTR_CTR; // clear IRQ bit
+			uint8_t ep = irqStatus & USB_EPADDR_FIELD;
+			usb_reg_t epStatus = USB_EpRegs(ep);
+
+			if (irqStatus & USB_ISTR_DIR) // OUT packet sent by host and received by device
+			{
+				EpClearCtrRx(ep, epStatus);
+
+				trace("->");
+
+				if (ep == EP_CTRL)
+				{
+					if (epStatus & USB_EP_SETUP)
+					{
+						trace("SETUP-");
+						OnSetup(); // Handle the Setup-Packet
+					}
+					else
+					{
+						trace("OUT-");
+						etrace(TR_CTRL_OUT, ep, 0);
+						OnEpCtrlOut(); // finished TX on CTRL endpoint
+					}
+				}
+				else if (ep == EP_DATA)
+				{
+					trace("DATA-");
+					etrace(TR_BULK_OUT, ep, Ep_rx_count(ep));
+#if USB_FRAME_STATS
+					CountPacket(Ep_rx_count(ep));
+#endif
+					OnEpBulkOut();
+				}
+				else if (ep == EP_COMM)
+				{
+					trace("COMM\n");
+//					OnEpIntOut();
+				}
+			}
+			else // IN, finished packet transmitted from device to host
+			{
+				// Apply new device address
+				if (deviceAddress)
+				{
+					USB_SetAddress(deviceAddress);
+					deviceAddress = 0;
+				}
+
+				EpClearCtrTx(ep, epStatus);
+
+				trace("<-");
+
+				if (ep == EP_CTRL)
+				{
+					trace("CTRL-");
+					etrace(TR_CTRL_IN, ep, 0);
+					OnEpCtrlIn();
+				}
+				else if (ep == EP_DATA)
+				{
+					trace("DATA-");
+					etrace(TR_BULK_IN, ep, 0);
+#if USB_FRAME_STATS
+					CountPacket(EpTable[ep].txCount & 0x3FF);
+#endif
+					OnEpBulkIn();
+				}
+				else if (ep == EP_COMM)
+				{
+					trace("COMM\n");
+//					OnEpIntIn();
+				}
+			}
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// the USB peripheral is powered, see Api_usb_begin()
+//-----------------------------------------------------------------------------
+bool USB_running(void)
+{
+	return !(USB_CNTR & USB_CNTR_PDWN);
+}
+
+#if USB_KEEP_ON_HANDOFF
+//-----------------------------------------------------------------------------
+// store the USB state for a user program taking over the enumerated device
+//-----------------------------------------------------------------------------
+void USB_save_state(boot_handoff_t * h)
+{
+	h->usb = HANDOFF_USB_KEPT;
+	h->usb_address = USB_DADDR & 0x7F;
+	h->usb_config = CMD.configuration;
+	h->usb_btable = USB_BTABLE;
+	h->usb_dtr_rts = Dtr_Rts;
+	for (int ep = 0; ep < HANDOFF_USB_EPS; ep++)
+		h->usb_epr[ep] = USB_EpRegs(ep);
+	memcpy(h->line_coding, &lineCoding, sizeof(h->line_coding));
+}
+#endif
+
+#endif // !USB_OTG
@@ -0,0 +1,685 @@
+/*
+ * usb_cmd.c
+ *
+ * Upload protocol and serial mode on EP_DATA, see usb_cmd.h
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "usb_func.h"
+#include "usb_cmd.h"
+#include "staging.h"
+#include "image.h"
+#include "events.h"
+#include "flash_engine.h"
+
+
+//-----------------------------------------------------------------------------
+//  Variables
+//-----------------------------------------------------------------------------
+bool cdc_tx_busy;
+bool session_open; // session without page count, ended by CMD_RUN or CMD_RESET
+uint32_t run_address; // CMD_RUN, 0 = active slot
+uint32_t tx_done_event; // raised when the acknowledge was sent, see OnEpBulkIn()
+static uint8_t activate_cmd; // CMD_RUN or CMD_RESET waiting for Command_activate()
+
+//-----------------------------------------------------------------------------
+// manage data to be transmitted to host via EP_DATA IN
+//-----------------------------------------------------------------------------
+__ramfunc void OnEpBulkIn(void)
+{
+//	SendData(EP_DATA, (uint8*)&ZERO, 0);
+	cdc_tx_busy = false;
+	if ( tx_done_event )
+	{	// the host has the acknowledge, the USB may be turned off now
+		Event_set(tx_done_event);
+		tx_done_event = 0;
+	}
+	trace("done\n");
+}
+//-----------------------------------------------------------------------------
+static uint8_t seg_failed; // SEGMENT_CRC_FAILED
+static uint8_t activate_err; // ACTIVATE_FAILED, STAGE_ERR_xxx of Slot_activate()
+__ramfunc void SendError(error_t err)
+{
+	trace("ERR:"); ntrace(err, 0); trace("-");
+	etrace(TR_ERROR, EP_DATA, err);
+	if ( err==FLASH_VERIFY_FAILED )
+	{	// error code and the failing address, kept till a new session
+		uint8_t buf[5] = { err, flash_fail_addr, flash_fail_addr>>8, flash_fail_addr>>16, flash_fail_addr>>24 };
+		SendData(EP_DATA, buf, sizeof(buf));
+	}
+	else if ( err==SEGMENT_CRC_FAILED )
+	{
+		uint8_t buf[2] = { err, seg_failed };
+		SendData(EP_DATA, buf, sizeof(buf));
+	}
+	else if ( err==ACTIVATE_FAILED )
+	{
+		uint8_t buf[2] = { err, activate_err };
+		SendData(EP_DATA, buf, sizeof(buf));
+	}
+	else
+		SendData(EP_DATA, &err, sizeof(error_t));
+	trace("\n");
+}
+
+//-----------------------------------------------------------------------------
+uint8_t rx_buf[EP_DATA_LEN];
+int num_pages; // number of total pages to flash
+int crt_page; // currently flashed pages
+uint32_t upload_base; // slot the upload is written into, see staging.h
+uint16_t upload_version; // image version given by the uploader, see image.h
+int page_offset, page_len, header_ok;
+static uint32_t page_addr; // flash address of the current page
+cmd_t _cmd;
+
+// image length and checksum given by the host with CMD_IMAGE. Without them
+// the image is the written data, its checksum is computed from the flash.
+static image_info_t image;
+static bool image_given;
+static bool image_info; // expected in the data stage
+static uint32_t upload_len; // end of the written data, from upload_base
+static bool in_place; // too large for slot B, written from USER_PROGRAM, see staging.h
+
+#define LEN_PAGES(len)		(((len) + PAGE_SIZE-1) / PAGE_SIZE)
+
+//-----------------------------------------------------------------------------
+// largest image of the session. The page count, the pages and the length of
+// CMD_IMAGE are checked against it, the last page only up to this length.
+//-----------------------------------------------------------------------------
+static __ramfunc uint32_t Upload_max_len(void)
+{
+	return in_place ? IN_PLACE_MAX_LEN : Slot_max_len(upload_base);
+}
+
+//-----------------------------------------------------------------------------
+// Segment session (CMD_SEGMENTS): the segments are written in place, the
+// pages are numbered over all segments in the order of the table. The table
+// has to be in ascending order of the addresses. A segment starting at
+// SLOT_A_ADDR is the image, it gets the trailer after the session.
+//-----------------------------------------------------------------------------
+segment_t segments[SEGMENTS_MAX];
+uint8_t seg_count; // 0: single image session
+static uint8_t seg_table; // segments of the table expected in the data stage
+
+#define SEG_PAGES(s)		(((s)->len + PAGE_SIZE-1) / PAGE_SIZE)
+#define SEG_END(s)			((s)->addr + SEG_PAGES(s) * PAGE_SIZE)
+
+//-----------------------------------------------------------------------------
+// check the received segment table, sets the total number of pages. The
+// segments lie in the user flash, not in the bootloader and not in the
+// flash of the activation record.
+//-----------------------------------------------------------------------------
+static __ramfunc error_t Segments_check(void)
+{
+	uint32_t end = USER_PROGRAM;
+	int pages = 0;
+	for (int i = 0; i < seg_count; i++)
+	{
+		const segment_t * seg = &segments[i];
+		if ( seg->addr < USER_PROGRAM || seg->addr >= FLASH_BASE + FLASH_SIZE )
+			return CMD_WRONG_ADDRESS;
+		if ( (seg->addr & (PAGE_SIZE-1)) || seg->addr < end ||
+			 seg->len==0 || seg->len > FLASH_BASE + FLASH_SIZE - seg->addr )
+			return CMD_WRONG_ADDRESS;
+		if ( SEG_END(seg) > RECORD_ERASE_ADDR )
+			return CMD_WRONG_ADDRESS;
+		end = SEG_END(seg);
+		pages += SEG_PAGES(seg);
+	}
+#if USB_PAGE_FROM_HEADER
+	if ( pages > 0x100 ) // the page number in the header has 8 bits
+		return DATA_OVERFLOW;
+#endif
+	if ( segments[0].addr==SLOT_A_ADDR )
+	{	// the image, the page of its trailer is not written by another segment
+		if ( segments[0].len > Slot_max_len(SLOT_A_ADDR) )
+			return DATA_OVERFLOW;
+		for (int i = 1; i < seg_count; i++)
+			if ( segments[i].addr <= IMAGE_TRAILER_ADDR && IMAGE_TRAILER_ADDR < SEG_END(&segments[i]) )
+				return CMD_WRONG_ADDRESS;
+	}
+	num_pages = pages;
+	return NO_ERROR;
+}
+//-----------------------------------------------------------------------------
+// the segment table, data stage of CMD_SEGMENTS. Opens the session.
+//-----------------------------------------------------------------------------
+static __ramfunc error_t Segments_receive(uint16_t rxd)
+{
+	seg_count = seg_table;
+	seg_table = 0;
+	if ( rxd != seg_count * sizeof(segment_t) )
+	{
+		seg_count = 0;
+		return CMD_WRONG_LENGTH;
+	}
+	ReadData(EP_DATA, (uint8_t *)segments, rxd);
+	error_t err = Segments_check();
+	if ( err )
+	{
+		seg_count = 0;
+		return err;
+	}
+	// slot A is written in place, its check is valid again when sealed
+	if ( segments[0].addr < SLOT_A_ADDR + SLOT_A_SIZE )
+		Image_invalidate();
+	upload_version = _cmd.data_len;
+	session_open = true; // ended by CMD_RUN or CMD_RESET
+	crt_page = 0;
+	Flash_engine_start();
+#if FLASH_SECTORS
+	// the sectors of the segments, the first packets are received meanwhile
+	for (int i = 0; i < seg_count; i++)
+		Flash_queue_erase_range(segments[i].addr, segments[i].len);
+#endif
+	// echo back the header again
+	SendData(EP_DATA, _cmd.data, sizeof(cmd_t));
+	return NO_ERROR;
+}
+//-----------------------------------------------------------------------------
+// index of the first segment with a wrong CRC, -1 if all are correct.
+// The CRC unit checks the segment as the trailer, see Image_crc().
+// Called when the flash engine is idle.
+//-----------------------------------------------------------------------------
+static __ramfunc int Segments_crc_check(void)
+{
+	for (int i = 0; i < seg_count; i++)
+		if ( Image_crc(segments[i].addr, segments[i].len) != segments[i].crc32 )
+			return i;
+	return -1;
+}
+//-----------------------------------------------------------------------------
+// CMD_SESSION, the header is valid for upload_base
+//-----------------------------------------------------------------------------
+static __ramfunc void Session_start(void)
+{
+	// page count 0: open session, the host ends it with CMD_RUN or CMD_RESET
+	session_open = (_cmd.page==0);
+	seg_count = 0;
+	crt_page = 0;
+	image_given = false;
+	upload_len = 0;
+	if ( upload_base==SLOT_A_ADDR )
+		Image_invalidate();
+	upload_version = _cmd.data_len;
+	Flash_engine_start();
+#if FLASH_SECTORS
+	// the sectors of the image, the first packets are received meanwhile.
+	// In slot B up to its end, this drops the activation record.
+	Flash_queue_erase_range(upload_base, (upload_base==SLOT_B_ADDR) ? STAGING_SIZE :
+			(_cmd.page ? (uint32_t)_cmd.page * PAGE_SIZE : SLOT_A_SIZE));
+#else
+	// drop the activation record, it is written again after the upload.
+	// An upload in place overwrites slot B.
+	if ( upload_base==SLOT_B_ADDR || in_place )
+		Flash_queue_erase(STAGING_INFO_ADDR);
+#endif
+	num_pages = _cmd.page; // this will be used to detect the end of upload
+}
+//-----------------------------------------------------------------------------
+// data stage of CMD_IMAGE
+//-----------------------------------------------------------------------------
+static __ramfunc error_t Image_receive(uint16_t rxd)
+{
+	image_info = false;
+	if ( rxd != sizeof(image_info_t) )
+		return CMD_WRONG_LENGTH;
+	ReadData(EP_DATA, (uint8_t *)&image, rxd);
+	if ( image.len==0 || image.len > Upload_max_len() ||
+		 (!session_open && image.len > (uint32_t)num_pages * PAGE_SIZE) )
+		return DATA_OVERFLOW;
+	image_given = true;
+	// echo back the header again
+	SendData(EP_DATA, _cmd.data, sizeof(cmd_t));
+	return NO_ERROR;
+}
+//-----------------------------------------------------------------------------
+// flash address of page "n" of the upload, 0 if beyond its end
+//-----------------------------------------------------------------------------
+static __ramfunc uint32_t Upload_page_addr(int n)
+{
+	if ( seg_count==0 )
+		return ( (uint32_t)n >= LEN_PAGES(Upload_max_len()) ) ? 0 : (upload_base + n * PAGE_SIZE);
+
+	for (int i = 0; i < seg_count; i++)
+	{
+		int pages = SEG_PAGES(&segments[i]);
+		if ( n < pages )
+			return segments[i].addr + n * PAGE_SIZE;
+		n -= pages;
+	}
+	return 0;
+}
+//-----------------------------------------------------------------------------
+// after the session: activate the uploaded slot, or the image of a segment
+// session. Only a complete session is activated: all pages of a counted
+// session written, or an open session covering the length of CMD_IMAGE.
+// Slot_activate() checks the image against the checksum of CMD_IMAGE,
+// its error is kept in activate_err. Called by Command_activate() and by
+// main(), the flash engine must be stopped. Returns true if activated.
+//-----------------------------------------------------------------------------
+static bool activated;
+
+bool Upload_activate(void)
+{
+	activate_err = STAGE_OK;
+	if ( activated || num_pages==0 || flash_errors )
+		return activated;
+	if ( seg_count==0 )
+	{
+		if ( session_open ? (image_given && upload_len < image.len) : (crt_page != num_pages) )
+			return false; // ended before the last page
+		if ( image_given )
+			activate_err = Slot_activate(upload_base, image.len, image.checksum, upload_version);
+		else
+			activate_err = Slot_activate(upload_base, upload_len,
+					Calculate_CRC((uint8_t*)upload_base, upload_len), upload_version);
+	}
+	else if ( segments[0].addr==SLOT_A_ADDR )
+	{	// the segments are checked with their CRC-32, Slot_activate() wants the 16 bit sum
+		if ( Segments_crc_check()>=0 )
+		{
+			activate_err = STAGE_ERR_CHECKSUM;
+			return false;
+		}
+		uint16_t checksum = Calculate_CRC( (uint8_t*) SLOT_A_ADDR, segments[0].len );
+		activate_err = Slot_activate(SLOT_A_ADDR, segments[0].len, checksum, upload_version);
+	}
+	activated = (activate_err==STAGE_OK);
+	return activated;
+}
+//-----------------------------------------------------------------------------
+// CMD_RUN / CMD_RESET, called by main() on EV_ACTIVATE: check the segments,
+// activate the upload and answer the command. On failure the session stays
+// open. The echo raises EV_RUN or EV_RESET when it was sent.
+//-----------------------------------------------------------------------------
+void Command_activate(void)
+{
+	error_t err = NO_ERROR;
+	int bad = seg_count ? Segments_crc_check() : -1;
+	if ( bad>=0 )
+	{	// the host may write the segment again
+		seg_failed = bad;
+		err = SEGMENT_CRC_FAILED;
+	}
+	else
+	{
+		Flash_engine_stop();
+		Upload_activate();
+		if ( activate_err )
+		{
+			Flash_engine_start();
+			err = ACTIVATE_FAILED;
+		}
+	}
+
+	DisableUsbIRQ(); // EP_DATA is shared with the interrupt
+	if ( err )
+		SendError(err);
+	else
+	{	// echo back the header
+		tx_done_event = (activate_cmd==CMD_RUN) ? EV_RUN : EV_RESET;
+		SendData(EP_DATA, _cmd.data, sizeof(cmd_t));
+	}
+	activate_cmd = 0;
+	MarkBufferRxDone(EP_DATA); // release data EP Rx for next OUT packet
+	EnableUsbIRQ();
+}
+//-----------------------------------------------------------------------------
+// Patch (CMD_PATCH): a few bytes written in place by a read-modify-write of
+// their page, see Flash_queue_patch(). The sealed image and the trailer are
+// not patched, their checksum would not match any more.
+//-----------------------------------------------------------------------------
+static uint8_t patch_len; // bytes expected in the data stage
+
+//-----------------------------------------------------------------------------
+// data stage of CMD_PATCH: the address (uint32_t) and the bytes
+//-----------------------------------------------------------------------------
+static __ramfunc error_t Patch_receive(uint8_t * buf, uint16_t rxd)
+{
+	uint32_t len = patch_len;
+	patch_len = 0;
+	if ( rxd != 4 + len )
+		return CMD_WRONG_LENGTH;
+	ReadData(EP_DATA, rx_buf, rxd);
+	uint32_t addr = rx_buf[0] | (rx_buf[1]<<8) | (rx_buf[2]<<16) | ((uint32_t)rx_buf[3]<<24);
+	if ( addr < USER_PROGRAM || addr >= FLASH_BASE + FLASH_SIZE || len > FLASH_BASE + FLASH_SIZE - addr ||
+		 (addr & (PAGE_SIZE-1)) + len > PAGE_SIZE )
+		return CMD_WRONG_ADDRESS;
+	uint32_t protect = (IMAGE_TRAILER->magic==IMAGE_MAGIC) ? SLOT_A_ADDR : IMAGE_TRAILER_ADDR;
+	if ( addr < IMAGE_TRAILER_ADDR + sizeof(image_trailer_t) && addr + len > protect )
+		return CMD_WRONG_ADDRESS;
+	for (uint32_t i = 0; i < len; i++)
+		buf[i] = rx_buf[4 + i];
+	if ( !Flash_queue_patch(addr, len) )
+		return PATCH_NEEDS_ERASE;
+	// echo back the header again, a failed verify is reported with the next command
+	SendData(EP_DATA, _cmd.data, sizeof(cmd_t));
+	return NO_ERROR;
+}
+//-----------------------------------------------------------------------------
+__ramfunc error_t CheckHeader(uint16 rxd)
+{
+	// data should be command, plausibility check
+	if (rxd!=sizeof(cmd_t))
+	{
+		trace("~NO_LEN~");
+		return CMD_WRONG_LENGTH;
+	}
+	// read header
+	ReadData(EP_DATA, _cmd.data, rxd);
+	// check crc
+	if ( Check_CRC(_cmd.data, sizeof(cmd_t))==0 )
+	{
+		trace("~NO_CRC~");
+		return CMD_WRONG_CRC;
+	}
+	etrace(TR_HEADER, EP_DATA, _cmd.id);
+	return NO_ERROR;
+}
+
+//-----------------------------------------------------------------------------
+// execute a valid command header
+//-----------------------------------------------------------------------------
+__ramfunc error_t OnCommand(void)
+{
+	int page;
+	switch (_cmd.id)
+	{
+	case CMD_SESSION:
+		// a session which failed the verify is given up by a new one
+		if ( (num_pages!=0 || session_open) && !flash_errors )
+			break;
+		// the active slot is not touched
+		upload_base = Slot_inactive();
+		in_place = false;
+		if ( upload_base==SLOT_B_ADDR && _cmd.page > LEN_PAGES(Slot_max_len(SLOT_B_ADDR)) )
+		{	// too large for slot B, written in place
+			upload_base = SLOT_A_ADDR;
+			in_place = true;
+		}
+		if ( _cmd.page > LEN_PAGES(Upload_max_len()) )
+			return DATA_OVERFLOW;
+		Session_start();
+		// echo back the header
+		SendData(EP_DATA, _cmd.data, sizeof(cmd_t));
+		return NO_ERROR;
+
+	case CMD_IMAGE:
+		// within a session of CMD_SESSION, before its last page
+		if ( upload_base==0 || seg_count || (num_pages==0 && !session_open) ||
+			 (!session_open && crt_page==num_pages) )
+			break;
+		// echo back the header, the image length and checksum follow
+		SendData(EP_DATA, _cmd.data, sizeof(cmd_t));
+		image_info = true;
+		header_ok = 1;
+		MarkBufferRxDone(EP_DATA); // release data EP Rx for next OUT packet
+		return NO_ERROR;
+
+	case CMD_SEGMENTS:
+		if ( (num_pages!=0 || session_open) && !flash_errors )
+			break;
+		if ( _cmd.page==0 || _cmd.page > SEGMENTS_MAX )
+			return DATA_OVERFLOW;
+		// echo back the header, the segment table follows
+		SendData(EP_DATA, _cmd.data, sizeof(cmd_t));
+		seg_table = _cmd.page;
+		header_ok = 1;
+		MarkBufferRxDone(EP_DATA); // release data EP Rx for next OUT packet
+		return NO_ERROR;
+
+	case CMD_PAGE:
+		if (num_pages==0 && !session_open)
+			break;
+		if ( flash_errors )
+			return FLASH_VERIFY_FAILED;
+#if USB_PAGE_FROM_HEADER
+		page = _cmd.page; // offset page number starting from upload_base
+#else
+		page = crt_page;
+#endif
+		if ( Upload_page_addr(page)==0 )
+			return DATA_OVERFLOW;
+		if ( seg_count==0 && (uint32_t)page * PAGE_SIZE + _cmd.data_len > Upload_max_len() )
+			return DATA_OVERFLOW; // the last page up to the trailer or the activation record
+		// echo back the header
+		SendData(EP_DATA, _cmd.data, sizeof(cmd_t));
+		// prepare data stage
+		page_offset = 0;
+		header_ok = 1;
+		crt_page = page;
+		page_addr = Upload_page_addr(page);
+		page_len = _cmd.data_len;
+		// erase the corresponding page, a free job is assured by Bulk_out_data()
+		Flash_queue_erase( page_addr );
+		MarkBufferRxDone(EP_DATA); // release data EP Rx for next OUT packet
+		return NO_ERROR;
+
+	case CMD_PATCH:
+		if (num_pages!=0 && !session_open)
+			break;
+		if ( flash_errors )
+			return FLASH_VERIFY_FAILED;
+		if ( _cmd.data_len==0 || _cmd.data_len > EP_DATA_LEN-4 )
+			return CMD_WRONG_LENGTH;
+		if ( !session_open )
+		{	// ended by CMD_RUN or CMD_RESET
+			session_open = true;
+			Flash_engine_start();
+		}
+		// echo back the header, the address and the bytes follow
+		SendData(EP_DATA, _cmd.data, sizeof(cmd_t));
+		patch_len = _cmd.data_len;
+		header_ok = 1;
+		MarkBufferRxDone(EP_DATA); // release data EP Rx for next OUT packet
+		return NO_ERROR;
+
+	case CMD_RUN:
+		if ( flash_errors )
+			return FLASH_VERIFY_FAILED;
+		if ( _cmd.data_len==0 )
+			run_address = 0;
+		else
+		{
+			run_address = FLASH_BASE + _cmd.data_len * PAGE_SIZE;
+			if ( run_address < USER_PROGRAM || run_address >= FLASH_BASE + FLASH_SIZE
+				|| !Check_user_code(run_address) )
+				return CMD_WRONG_ADDRESS;
+		}
+		// fall through
+	case CMD_RESET:
+		if ( flash_errors ) // nothing is activated, the host may start a new session
+			return FLASH_VERIFY_FAILED;
+		// all writes are verified. The CRC checks and the activation take
+		// milliseconds, they run in main(), EP Rx stays on NAK till answered
+		activate_cmd = _cmd.id;
+		Event_set(EV_ACTIVATE);
+		return NO_ERROR;
+
+#if USB_FRAME_STATS
+	case CMD_STATS:
+		usb_stats.verify_us = flash_verify_cycles / (F_CPU/1000000);
+		usb_stats.verify_retries = flash_retries;
+		SendData(EP_DATA, (uint8_t*)&usb_stats, sizeof(usb_stats_t));
+		return NO_ERROR;
+#endif
+
+	default:
+		break;
+	}
+	trace("~NO_ID~");
+	return CMD_WRONG_ID;
+}
+
+//-----------------------------------------------------------------------------
+// Serial mode for the user program, see boot_api.h.
+// The received packet is copied to rx_buf, EP_DATA Rx is released only
+// after all bytes have been read.
+//-----------------------------------------------------------------------------
+bool usb_serial;
+int cdc_rx_len, cdc_rx_pos;
+
+bool Cdc_connected(void)
+{
+	return usb_state.configured && !usb_state.suspended;
+}
+//-----------------------------------------------------------------------------
+int Cdc_available(void)
+{
+	return cdc_rx_len - cdc_rx_pos;
+}
+//-----------------------------------------------------------------------------
+int Cdc_read(uint8_t * buf, int max)
+{
+	int n = cdc_rx_len - cdc_rx_pos;
+	if (n > max)
+		n = max;
+	memcpy(buf, rx_buf + cdc_rx_pos, n);
+	cdc_rx_pos += n;
+	if ( cdc_rx_len>0 && cdc_rx_pos==cdc_rx_len )
+	{	// all read, accept the next packet
+		cdc_rx_len = cdc_rx_pos = 0;
+		MarkBufferRxDone(EP_DATA);
+	}
+	return n;
+}
+//-----------------------------------------------------------------------------
+int Cdc_write(const uint8_t * buf, int len)
+{
+	if ( !Cdc_connected() || cdc_tx_busy )
+		return 0;
+	cdc_tx_busy = true;
+	return SendData(EP_DATA, (uint8_t *)buf, len);
+}
+
+//-----------------------------------------------------------------------------
+// upload protocol. Each packet needs a free flash job (page erase for a
+// CMD_PAGE header, or the packet data), else it is held in the endpoint
+// buffer with EP_DATA Rx on NAK till a job is done.
+//-----------------------------------------------------------------------------
+bool rx_held;
+
+// a command which has to wait for the flash engine, see flash_engine.h
+static __ramfunc bool Command_waits(void)
+{
+	switch (_cmd.id)
+	{
+	case CMD_PAGE:
+		return !Flash_can_erase();
+	case CMD_SESSION:
+	case CMD_SEGMENTS: // may restart the engine after a failed session
+		return flash_errors && !Flash_engine_idle();
+	case CMD_PATCH: // reads the page
+	case CMD_RUN:
+	case CMD_RESET:
+		return !Flash_engine_idle(); // answered when all writes are verified
+	default:
+		return false;
+	}
+}
+
+static __ramfunc void Bulk_out_data(uint16_t rxd)
+{
+	error_t err = NO_ERROR;
+
+	uint8_t * buf = Flash_job_buffer();
+	if ( buf==NULL )
+	{
+		rx_held = true;
+		return;
+	}
+
+	if (header_ok==0)
+	{	// check for command header
+		err = CheckHeader(rxd);
+		if ( err==NO_ERROR && Command_waits() )
+		{	// read again from the endpoint buffer when a job is done
+			rx_held = true;
+			return;
+		}
+		if ( err==NO_ERROR )
+		{
+			err = OnCommand();
+			if ( err==NO_ERROR && header_ok )
+				return; // EP Rx was already released
+			if ( err==NO_ERROR && activate_cmd )
+				return; // released by Command_activate()
+		}
+	}
+	else if (image_info)
+	{	// data stage of CMD_IMAGE
+		header_ok = 0;
+		err = Image_receive(rxd);
+	}
+	else if (seg_table)
+	{	// data stage of CMD_SEGMENTS
+		header_ok = 0;
+		err = Segments_receive(rxd);
+	}
+	else if (patch_len)
+	{	// data stage of CMD_PATCH
+		header_ok = 0;
+		err = Patch_receive(buf, rxd);
+	}
+	else if (page_len>0)
+	{	// data stage. store data packet into the job buffer, the flash engine writes it
+		ReadData(EP_DATA, buf, rxd);
+		Flash_queue_write( page_addr + page_offset, rxd );
+		// update page index
+		page_offset += rxd;
+		if ( seg_count==0 && page_addr + page_offset - upload_base > upload_len )
+			upload_len = page_addr + page_offset - upload_base;
+		// check if buffer full
+		if (page_offset>=page_len)
+		{	// it was the last data packet from the current page. prepare header stage
+			crt_page++; // to detect end of upload
+			header_ok = 0;
+			page_len = 0;
+			if ( session_open ) {
+				if ( crt_page > num_pages )
+					num_pages = crt_page; // the length of the image
+			}
+			else if (crt_page == num_pages) {
+				etrace(TR_COMPLETE, EP_DATA, crt_page);
+				Event_set(EV_UPLOAD_DONE); // main() waits for the flash engine
+			}
+		}
+	}
+
+	if (err)
+		SendError(err);
+
+	MarkBufferRxDone(EP_DATA); // release data EP Rx for next OUT packet
+}
+//-----------------------------------------------------------------------------
+// a flash job is done, take the held packet
+//-----------------------------------------------------------------------------
+__ramfunc void OnFlashJobDone(void)
+{
+	if ( rx_held )
+	{
+		rx_held = false;
+		Bulk_out_data( Ep_rx_count(EP_DATA) );
+	}
+}
+//-----------------------------------------------------------------------------
+__ramfunc void OnEpBulkOut(void)
+{
+	// read number of available bytes
+	uint16_t rxd = Ep_rx_count(EP_DATA);
+
+	if (usb_serial)
+	{	// user data, keep EP_DATA Rx on NAK till read by Cdc_read()
+		ReadData(EP_DATA, rx_buf, rxd);
+		cdc_rx_pos = 0;
+		cdc_rx_len = rxd;
+		if (rxd==0)
+			MarkBufferRxDone(EP_DATA);
+		return;
+	}
+
+	Bulk_out_data(rxd);
+}
@@ -0,0 +1,40 @@
+/*
+ * usb_cmd.h
+ *
+ * Interface between the USB device driver and the class code.
+ *
+ * The driver handles the bus events and moves the packets: common/usb.c for
+ * the USB FS device of F1 and F3, usb_otg.c for the OTG FS core of F4.
+ * The requests on the control endpoint are handled by usb_ctrl.c, the packets
+ * of EP_DATA by usb_cmd.c (upload protocol and serial mode of the boot API).
+ * A received packet stays in the driver till MarkBufferRxDone(), meanwhile
+ * the host gets NAKs.
+ */
+
+#ifndef USB_CMD_H
+#define USB_CMD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// class code, called by the driver in the USB interrupt
+extern void OnSetup(void); // a SETUP packet was received on EP_CTRL
+extern void OnEpCtrlOut(void);
+extern void OnEpCtrlIn(void);
+extern void OnEpBulkOut(void); // a packet was received on EP_DATA
+extern void OnEpBulkIn(void); // the packet written by SendData(EP_DATA) was sent
+extern uint8_t deviceAddress; // SET_ADDRESS, applied by the driver after the status stage
+
+// driver, called by the protocol
+extern uint16_t Ep_rx_count(int ep); // bytes of the received packet
+extern void ReadData(int ep, uint8_t* dest, int count);
+extern void MarkBufferRxDone(int ep); // release the packet, accept the next one
+extern void Stall_EPAddr(int epNum); // bit 7 set: IN endpoint
+extern void Stall(int ep);
+extern void UnStall(int ep);
+extern bool USB_running(void); // the USB peripheral is powered and clocked
+#if USB_FRAME_STATS
+extern void CountPacket(uint16_t len);
+#endif
+
+#endif // USB_CMD_H
@@ -1,15 +1,14 @@
 /*
- * usb.h
+ * usb_ctrl.c
  *
- *  Created on: Apr 25, 2020
- *      Author: stevestrong
+ * Standard and CDC class requests on the control endpoint, shared by the
+ * USB drivers (see usb_cmd.h)
  */
-// Use USB as virtual COM Port
 
-#include <stddef.h>
-#include <usb_std.h>
+#include "usb_std.h"
 #include "usb_func.h"
 #include "usb_desc.h"
+#include "usb_cmd.h"
 
 
 //-----------------------------------------------------------------------------
@@ -21,12 +20,7 @@ lineCoding_t lineCoding;
 status_t usb_state;
 
 uint16_t Dtr_Rts;
-uint8_t deviceAddress;
-const epTableAddress_t epTableAddr[EP_LAST] = { //; // number of EPs
-	{ .txAddr = (uint32_t*)EP_CTRL_TX_BUF_ADDRESS, .rxAddr = (uint32_t*)EP_CTRL_RX_BUF_ADDRESS },
-	{ .txAddr = (uint32_t*)EP_DATA_TX_BUF_ADDRESS, .rxAddr = (uint32_t*)EP_DATA_RX_BUF_ADDRESS },
-	{ .txAddr = (uint32_t*)EP_COMM_TX_BUF_ADDRESS, .rxAddr = (uint32_t*)EP_COMM_RX_BUF_ADDRESS },
-};
+uint8_t deviceAddress; // applied by the driver when the status stage is done
 
 // constant to send zero byte packets
 const uint8_t ZERO = 0;
@@ -46,217 +40,6 @@ void Class_Start(void)
     usb_state.both = false;
 }
 
-//-----------------------------------------------------------------------------
-// helper routines
-//-----------------------------------------------------------------------------
-void Stall_EPAddr(int epNum)
-{
-	trace("stall\n");
-	uint16 shift, mask;
-
-	if ( epNum & 0x80 ) // IN EP
-	{
-		epNum &= 0x7F; // remove bit 7
-		mask = USB_EPREG_NO_TOGGLE_MASK | USB_EPRX_STAT; // without STAT_TX and without both DTOG_x
-		shift = 1 << 12;
-	}
-	else
-	{
-		mask = USB_EPREG_NO_TOGGLE_MASK | USB_EPTX_STAT; // without STAT_RX and without both DTOG_x
-		shift = 1 << 4;
-	}
-	uint32_t data = USB_EpRegs(epNum);
-	USB_EpRegs(epNum) = (data ^ shift) & mask;
-}
-//-----------------------------------------------------------------------------
-void UnStall_EPAddr(int epNum)
-{
-	trace("unstall\n");
-	uint16 shift, mask;
-
-	if ( epNum & 0x80 )
-	{
-		epNum &= 0x7F; // remove bit 7
-		mask = USB_EPREG_NO_TOGGLE_MASK | USB_EPRX_STAT; // without STAT_TX and without both DTOG_x
-		shift = 3 << 12; // RX = VALID
-	}
-	else
-	{
-		mask = USB_EPREG_NO_TOGGLE_MASK | USB_EPTX_STAT; // without STAT_RX and without both DTOG_x
-		shift = 2 << 4; // TX = NAK
-	}
-	uint16 data = USB_EpRegs(epNum);
-	USB_EpRegs(epNum) = (data ^ shift) & mask;
-}
-
-//-----------------------------------------------------------------------------
-void Stall(int ep)
-{
-	Stall_EPAddr(USB_EP_ADDR_OUT(ep));
-	Stall_EPAddr(USB_EP_ADDR_IN(ep));
-}
-//-----------------------------------------------------------------------------
-void UnStall(int ep)
-{
-	UnStall_EPAddr(USB_EP_ADDR_OUT(ep));
-	UnStall_EPAddr(USB_EP_ADDR_IN(ep));
-}
-
-//-----------------------------------------------------------------------------
-// mark EP ready to receive, set STAT_RX to "11" by toggling
-//-----------------------------------------------------------------------------
-void MarkBufferRxDone(int ep)
-{
-	strace("clrBuf logEpNum=%i\n", ep);
-	uint16 mask = USB_EPREG_NO_TOGGLE_MASK | USB_EPRX_STAT; // without STAT_TX and without both DTOG_x
-	uint16 data = USB_EpRegs(ep);
-	USB_EpRegs(ep) = (data ^ USB_EPRX_STAT) & mask;
-}
-
-//-----------------------------------------------------------------------------
-// mark EP ready to transmit, set STAT_TX to "11" by toggling
-//-----------------------------------------------------------------------------
-void MarkBufferTxReady(int ep)
-{
-	strace("validateBuf logEpNum=%i\n", ep);
-	uint16 mask = USB_EPREG_NO_TOGGLE_MASK | USB_EPTX_STAT; // without STAT_RX and without both DTOG_x
-	uint16 data = USB_EpRegs(ep);
-	USB_EpRegs(ep) = (data ^ USB_EPTX_STAT) & mask;
-}
-
-//-----------------------------------------------------------------------------
-// initialize the EPs
-//-----------------------------------------------------------------------------
-void InitEndpoints(void)
-{
-	trace("InitEPs\n");
-	USB_CNTR = 1;          // Reset and clear Ints
-	CMD.configuration = 0;
-	CMD.transferLen = 0;   // no transfers
-	CMD.packetLen = 0;
-	CMD.transferPtr = 0;
-	USB_CNTR = 0;          // release reset
-	usb_state.suspended = false;
-	usb_state.configured = false;
-
-	// EP0 ist always reserved for control
-	// the other endpoints must match the numbers written in the descriptors
-	// see usb_desc.c: EP_DATA_IN, EP_DATA_OUT, EP_COMM_IN
-
-	// EP0 = Control, IN und OUT
-	EpTable[EP_CTRL].txOffset = EP_CTRL_TX_OFFSET;
-	EpTable[EP_CTRL].txCount = 0;
-	EpTable[EP_CTRL].rxOffset = EP_CTRL_RX_OFFSET;
-	EpTable[EP_CTRL].rxCount = EP_RX_LEN_ID;
-
-	// EP1 = Bulk IN and OUT
-	EpTable[EP_DATA].txOffset = EP_DATA_TX_OFFSET;
-	EpTable[EP_DATA].txCount = 0;
-	EpTable[EP_DATA].rxOffset = EP_DATA_RX_OFFSET;
-	EpTable[EP_DATA].rxCount = EP_RX_LEN_ID;
-
-	// EP2 = Int IN and OUT
-	EpTable[EP_COMM].txOffset = EP_COMM_TX_OFFSET;
-	EpTable[EP_COMM].txCount = 0;
-	EpTable[EP_COMM].rxOffset = EP_COMM_RX_OFFSET;
-	EpTable[EP_COMM].rxCount = EP_RX_LEN_ID;
-
-	USB_BTABLE = EP_TABLE_ADDR_OFFSET; // the table start offset from USB_PMAADDR
-
-	// CTRL EP
-	USB_EP0R =			// EP0 = Control, IN and OUT
-		(3 << 12) |		// STAT_RX = 3, Rx enabled
-		(2 << 4) |		// STAT_TX = 2, NAK
-		(1 << 9) |		// EP_TYPE = 1, Control
-		EP_CTRL;
-	// DATA EP
-	USB_EP1R =			// EP1 = Bulk IN and OUT
-		(3 << 12) |		// STAT_RX = 3, Rx enabled
-		(2 << 4) |		// STAT_TX = 2, NAK
-		(0 << 9) |		// EP_TYPE = 0, Bulk
-		EP_DATA;
-	// COMM EP
-	USB_EP2R =			// EP2 = Int, IN und OUT
-		(3 << 12) |		// STAT_RX = 3, Rx enabled
-		(2 << 4) |		// STAT_TX = 2, NAK
-		(3 << 9) |		// EP_TYPE = 3, INT
-		EP_COMM;
-
-	USB_ISTR = 0;          // clear pending Interrupts
-	USB_CNTR =
-		USB_CNTR_CTRM |             // Irq by ACKed Pakets
-		USB_CNTR_RESETM |           // Irq by Reset
-		USB_CNTR_SUSPM | USB_CNTR_WKUPM;
-
-	USB_SetAddress(0);
-}
-
-//-----------------------------------------------------------------------------
-// reads up to a given number of even bytes from control EP receive buffer
-//-----------------------------------------------------------------------------
-void Read_PMA(uint8_t* dest, uint32_t * src, int count)
-{
-	trace("rx="); ntrace(count, 0); trace("-");
-
-	if (!count) return;
-
-	if (count > EP_DATA_LEN)
-		count = EP_DATA_LEN;
-
-	int i = count/2;
-	while (i--)
-	{
-		UMEM_FAKEWIDTH val = *src++;
-		*dest++ = val;
-		*dest++ = val>>8;
-	}
-	if (count&1) { // read last odd byte if any
-		UMEM_FAKEWIDTH val = *src;
-		*dest = val;
-	}
-}
-//-----------------------------------------------------------------------------
-// reads up to a given number of even bytes from control EP receive buffer
-//-----------------------------------------------------------------------------
-void ReadData(int ep, uint8_t* dest, int count)
-{
-	int rd = EpTable[ep].rxCount & 0x3FF;
-	if (count>rd)
-		count = rd;
-	Read_PMA(dest, epTableAddr[ep].rxAddr, count);
-	if (ep==EP_CTRL)
-		MarkBufferRxDone(EP_CTRL); // release EP0 Rx
-}
-//-----------------------------------------------------------------------------
-// writes up to 64 bytes into the specified EP transmit buffer
-//-----------------------------------------------------------------------------
-int SendData(int ep, uint8_t * src, int count)
-{
-	trace("tx="); ntrace(count, 0);
-
-	if (count > EP_DATA_LEN)
-		count = EP_DATA_LEN;
-
-	EpTable[ep].txCount = count;
-	if (count)
-	{
-		UMEM_FAKEWIDTH* dest = epTableAddr[ep].txAddr;
-		int j = count/2;
-		while (j--)
-		{
-		    register UMEM_FAKEWIDTH val = *src++;
-		    val |= (*src++) << 8;
-		    *dest++ = val;
-		}
-		if (count&1) // send last odd byte if any
-		{
-		    register UMEM_FAKEWIDTH val = *src;
-		    *dest = val;
-		}
-	}
-	MarkBufferTxReady(ep); // mark Tx buffer ready to be sent
-	return count;
-}
 
 //-----------------------------------------------------------------------------
 // Control-Transfers block transmission start
@@ -321,8 +104,7 @@ void DoSetClearFeature(bool value)
 
     default: // should not happen
         trace("?!?-");
-        //Stall_EPAddr(EP_CTRL_ADDR_IN); // send NAK ???
-        Stall_EPAddr(EP_CTRL_ADDR_OUT); // send NAK ???
+        Stall_EPAddr(EP_CTRL_ADDR_IN); // send STALL
         break;
     }
 }
@@ -398,7 +180,7 @@ void Req_GetStatus()
 
 	default:
 		trace("?!?-");
-		Stall_EPAddr(EP_CTRL_ADDR_OUT); // send NAK
+		Stall_EPAddr(EP_CTRL_ADDR_IN); // send NAK
 		return;
 	}
 
@@ -425,6 +207,7 @@ void Req_SetAddress()
 {
 	trace("SET_ADDR-");
 	deviceAddress = CMD.setupPacket.wValue;
+	etrace(TR_SET_ADDRESS, EP_CTRL, deviceAddress);
 	ACK();
 }
 //-----------------------------------------------------------------------------
@@ -473,7 +256,7 @@ void Req_GetDescriptor()
 				ptr = (const uint8_t*)descriptors[ind];
 				aLen = ptr[0];
 			} else {
-				goto doStall; //Stall_EPAddr(EP_CTRL_ADDR_OUT); // out of range index. send NAK
+				goto doStall; //Stall_EPAddr(EP_CTRL_ADDR_IN); // out of range index. send NAK
 			}
 			break;
 		}
@@ -485,7 +268,7 @@ void Req_GetDescriptor()
 			trace("!!!-");
 			ntrace(type,0);
 doStall:
-			Stall_EPAddr(EP_CTRL_ADDR_OUT); // unknown. send NAK
+			Stall_EPAddr(EP_CTRL_ADDR_IN); // unknown. send NAK
 			break;
 		}
 	}
@@ -515,6 +298,7 @@ void Req_GetConfiguration()
 void Req_SetConfiguration()
 {
 	trace("SET_CFG-");
+	etrace(TR_SET_CONFIG, EP_CTRL, CMD.setupPacket.wValue);
 
 	if (CMD.setupPacket.wValue == 0)
 	{
@@ -527,6 +311,10 @@ void Req_SetConfiguration()
 		Class_Start();
 		CMD.configuration = CMD.setupPacket.wValue & 0xFF;
 		usb_state.configured = true;
+#if USB_FRAME_STATS
+		if (usb_stats.config_us==0)
+			usb_stats.config_us = Boot_time_us(); // enumeration benchmark
+#endif
 	}
 	ACK();
 }
@@ -584,6 +372,7 @@ void OnSetup(void)
 {
 	// read the setup packet form CTRL EP buffer
 	ReadData(EP_CTRL, (uint8_t*)&CMD.setupPacket, 8);
+	etrace(TR_SETUP, EP_CTRL, (CMD.setupPacket.bmRequestType<<8) | CMD.setupPacket.bRequest);
 
 	if (IsStandardRequest()) // Type = Standard
 	{
@@ -635,7 +424,7 @@ void OnSetup(void)
 	trace("REQ_?!?-");
 
 	// if request not recognized then send NAK
-	Stall_EPAddr(EP_CTRL_ADDR_OUT);
+	Stall_EPAddr(EP_CTRL_ADDR_IN);
 }
 
 //-----------------------------------------------------------------------------
@@ -700,212 +489,3 @@ void OnEpCtrlIn(void) // Control-EP IN
 	trace("Done\n");
 }
 
-//-----------------------------------------------------------------------------
-// manage data to be transmitted to host via EP_DATA IN
-//-----------------------------------------------------------------------------
-void OnEpBulkIn(void)
-{
-//	SendData(EP_DATA, (uint8*)&ZERO, 0);
-	trace("done\n");
-}
-//-----------------------------------------------------------------------------
-// Read received bytes and write them directly into the ring buffer
-// This need special handling due to the "ring" characteristic,
-// to safeguard the write pointer against going out of boundary
-//-----------------------------------------------------------------------------
-void SendError(error_t err)
-{
-	trace("ERR:"); ntrace(err, 0); trace("-");
-	SendData(EP_DATA, &err, sizeof(error_t));
-	trace("\n");
-}
-
-//-----------------------------------------------------------------------------
-uint8_t rx_buf[EP_DATA_LEN];
-int num_pages; // number of total pages to flash
-int crt_page; // currently flashed pages
-int page_offset, page_len, header_ok;
-cmd_t _cmd;
-//-----------------------------------------------------------------------------
-error_t CheckHeader(uint16 rxd, uint8 _id)
-{
-	// data should be command, plausibility check
-	if (rxd!=sizeof(cmd_t))
-	{
-		trace("~NO_LEN~");
-		return CMD_WRONG_LENGTH;
-	}
-	// read header
-	ReadData(EP_DATA, _cmd.data, rxd);
-	// check crc
-	if ( Check_CRC(_cmd.data, sizeof(cmd_t))==0 )
-	{
-		trace("~NO_CRC~");
-		return CMD_WRONG_CRC;
-	}
-	// valid command received. check for id
-	if (_cmd.id!=_id)
-	{
-		trace("~NO_ID~");
-		return CMD_WRONG_ID;
-	}
-	// echo back the header
-	SendData(EP_DATA, _cmd.data, sizeof(cmd_t));
-	return NO_ERROR;
-}
-
-//-----------------------------------------------------------------------------
-void OnEpBulkOut(void)
-{
-	error_t err = NO_ERROR;
-	// read number of available bytes
-	uint16_t rxd = EpTable[EP_DATA].rxCount & 0x3FF;
-
-	if (num_pages==0)
-	{	// check for header to set number of pages
-		err = CheckHeader(rxd, 0x20);
-		if ( err==NO_ERROR )
-		{
-			num_pages = _cmd.page; // this will be used to detect flash_complete
-		}
-	}
-	else if (header_ok==0)
-	{	// check for data header
-		err = CheckHeader(rxd, 0x21);
-		if ( err==NO_ERROR )
-		{ // prepare data stage
-			TIME_STAMP
-			page_offset = 0;
-			header_ok = 1;
-			crt_page = _cmd.page; // offset page number starting from USER_PROGRAM
-			page_len = _cmd.data_len;
-			MarkBufferRxDone(EP_DATA); // release data EP Rx for next OUT packet
-			// erase the corresponding page
-			LED_ON;
-			flash_erase_page( (uint16_t*) ( USER_PROGRAM + (crt_page * PAGE_SIZE) ));
-			LED_OFF;
-			return;
-		}
-	}
-	else if (page_len>0)
-	{	// data stage. store data packet into buffer
-		ReadData(EP_DATA, rx_buf, rxd);
-		// flash the data from buffer
-		flash_write_data( (uint16_t*) ( USER_PROGRAM + (crt_page * PAGE_SIZE) + page_offset), (uint16_t*)rx_buf, (rxd+1)>>1);
-		// update page index
-		page_offset += rxd;
-		// check if buffer full
-		if (page_offset>=page_len)
-		{	// it was the last data packet from the current page. prepare header stage
-			crt_page++; // to detect end of upload
-			header_ok = 0;
-			page_len = 0;
-		}
-	}
-
-	if (err)
-		SendError(err);
-
-	MarkBufferRxDone(EP_DATA); // release data EP Rx for next OUT packet
-
-}
-//-----------------------------------------------------------------------------
-//--------------- USB-Interrupt-Handler ---------------------------------------
-//-----------------------------------------------------------------------------
-void NAME_OF_USB_IRQ_HANDLER(void)
-{
-    uint32_t irqStatus = USB_ISTR; // Interrupt-Status
-
-	if (irqStatus & USB_ISTR_WKUP) // Suspend-->Resume
-	{
-		trace("WKUP\n");
-		USB_CNTR &= ~(USB_CNTR_FSUSP | USB_CNTR_LPMODE);
-		usb_state.suspended = false;
-	}
-	else if (irqStatus & USB_ISTR_SUSP) // after 3 ms break -->Suspend
-	{
-		trace("SUSP\n");
-		usb_state.suspended = true;
-		USB_CNTR |= (USB_CNTR_FSUSP | USB_CNTR_LPMODE);
-	}
-
-	// clear here the other interrupt bits
-	USB_ISTR = ~(USB_ISTR_PMAOVR|USB_ISTR_ERR|USB_ISTR_WKUP|USB_ISTR_SUSP|USB_ISTR_RESET|USB_ISTR_SOF|USB_ISTR_ESOF); // clear diverse IRQ bits
-
-	if (irqStatus & USB_ISTR_RESET) // Bus Reset
-	{
-		trace("RESET\n");
-		CMD.configuration = 0;
-		InitEndpoints();
-	}
-	else
-	{	// Endpoint Interrupts
-		while ( (irqStatus = USB_ISTR) & USB_ISTR_CTR )
-		{
-			USB_ISTR = (uint16) ~(USB_ISTR_CTR); // clear IRQ bit
-			uint8_t ep = irqStatus & USB_EPADDR_FIELD;
-			uint16_t epStatus = USB_EpRegs(ep);
-
-			if (irqStatus & USB_ISTR_DIR) // OUT packet sent by host and received by device
-			{
-				USB_EpRegs(ep) = epStatus & ~USB_EP_CTR_RX & USB_EPREG_NO_TOGGLE_MASK;
-
-				trace("->");
-
-				if (ep == EP_CTRL)
-				{
-					if (epStatus & USB_EP_SETUP)
-					{
-						trace("SETUP-");
-						OnSetup(); // Handle the Setup-Packet
-					}
-					else
-					{
-						trace("OUT-");
-						OnEpCtrlOut(); // finished TX on CTRL endpoint
-					}
-				}
-				else if (ep == EP_DATA)
-				{
-					trace("DATA-");
-					OnEpBulkOut();
-				}
-				else if (ep == EP_COMM)
-				{
-					trace("COMM\n");
-//					OnEpIntOut();
-				}
-			}
-			else // IN, finished packet transmitted from device to host
-			{
-				// Apply new device address
-				if (deviceAddress)
-				{
-					USB_SetAddress(deviceAddress);
-					deviceAddress = 0;
-				}
-
-				USB_EpRegs(ep) = epStatus & ~USB_EP_CTR_TX & USB_EPREG_NO_TOGGLE_MASK;
-
-				trace("<-");
-
-				if (ep == EP_CTRL)
-				{
-					trace("CTRL-");
-					OnEpCtrlIn();
-				}
-				else if (ep == EP_DATA)
-				{
-					trace("DATA-");
-					OnEpBulkIn();
-				}
-				else if (ep == EP_COMM)
-				{
-					trace("COMM\n");
-//					OnEpIntIn();
-				}
-			}
-		}
-	}
-}
-
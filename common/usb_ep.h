@@ -0,0 +1,59 @@
+/*
+ * usb_ep.h
+ *
+ * Helpers to change the state of an endpoint register (USB_EPnR).
+ *
+ * The STAT_x and DTOG_x bits of EPnR are toggled by writing 1, the CTR_x bits
+ * are cleared by writing 0 and left unchanged by writing 1. To set a STAT_x
+ * field to a certain value, the current value is XORed with the wanted one and
+ * written back, all other toggle bits are written as 0 and both CTR_x bits as 1.
+ * This way each state change is one load and one store, the data toggles are
+ * never flipped and a transfer completed between the load and the store is
+ * not lost.
+ */
+
+#ifndef USB_EP_H
+#define USB_EP_H
+
+#include "usb_def.h"
+
+// the bits which are written unchanged (the rest are toggle or CTR bits)
+#define EP_KEEP_BITS	(USB_EPREG_NO_TOGGLE_MASK & ~(USB_EP_CTR_RX | USB_EP_CTR_TX))
+// write 1 = no effect
+#define EP_CTR_BITS		(USB_EP_CTR_RX | USB_EP_CTR_TX)
+
+_Static_assert((USB_EPREG_NO_TOGGLE_MASK & (USB_EP_DTOG_RX | USB_EP_DTOG_TX | USB_EPRX_STAT | USB_EPTX_STAT)) == 0,
+	"EPnR: the no-toggle mask must not contain toggle bits");
+_Static_assert((USB_EP_RX_VALID & ~USB_EPRX_STAT) == 0 && (USB_EP_TX_VALID & ~USB_EPTX_STAT) == 0,
+	"EPnR: STAT values out of their field");
+
+//-----------------------------------------------------------------------------
+// set STAT_RX to one of USB_EP_RX_DIS/STALL/NAK/VALID
+//-----------------------------------------------------------------------------
+static inline void EpSetStatRx(int ep, usb_reg_t stat)
+{
+	usb_reg_t reg = USB_EpRegs(ep);
+	USB_EpRegs(ep) = (usb_reg_t)( (reg & EP_KEEP_BITS) | EP_CTR_BITS | ((reg ^ stat) & USB_EPRX_STAT) );
+}
+//-----------------------------------------------------------------------------
+// set STAT_TX to one of USB_EP_TX_DIS/STALL/NAK/VALID
+//-----------------------------------------------------------------------------
+static inline void EpSetStatTx(int ep, usb_reg_t stat)
+{
+	usb_reg_t reg = USB_EpRegs(ep);
+	USB_EpRegs(ep) = (usb_reg_t)( (reg & EP_KEEP_BITS) | EP_CTR_BITS | ((reg ^ stat) & USB_EPTX_STAT) );
+}
+//-----------------------------------------------------------------------------
+// clear CTR_RX / CTR_TX, using the register value already read by the caller
+//-----------------------------------------------------------------------------
+static inline void EpClearCtrRx(int ep, usb_reg_t reg)
+{
+	USB_EpRegs(ep) = (usb_reg_t)( (reg & EP_KEEP_BITS) | USB_EP_CTR_TX );
+}
+//-----------------------------------------------------------------------------
+static inline void EpClearCtrTx(int ep, usb_reg_t reg)
+{
+	USB_EpRegs(ep) = (usb_reg_t)( (reg & EP_KEEP_BITS) | USB_EP_CTR_RX );
+}
+
+#endif // USB_EP_H
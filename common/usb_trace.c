@@ -0,0 +1,23 @@
+/*
+ * usb_trace.c
+ *
+ * Storage of the USB_DEBUG event trace, see usb_trace.h
+ */
+
+#include "usb_trace.h"
+
+#ifdef USB_DEBUG
+
+trace_rec_t trace_buf[TRACE_SIZE];
+uint32_t trace_cnt;
+
+//-----------------------------------------------------------------------------
+// the cycle counter used to time stamp the trace records is already running
+// since reset (see SystemInit), so the time stamps are relative to boot
+//-----------------------------------------------------------------------------
+void TraceInit(void)
+{
+	trace_cnt = 0;
+}
+
+#endif
@@ -0,0 +1,93 @@
+/*
+ * usb_trace.h
+ *
+ * Binary event trace for the USB_DEBUG build.
+ *
+ * Each event is stored as one fixed size record into a wrap-around ring buffer.
+ * Logging an event costs a few dozen cycles (no formatting, no divisions),
+ * so it can be used inside the USB ISR without disturbing the timing.
+ * The buffer is dumped over USART1 by TraceDump() and decoded on the host
+ * with tools/trace_decode.py. TraceDump() is implemented by the families
+ * with a USART driver (F3 dbg/usb_trx.c); on the others read trace_buf
+ * and trace_cnt with the debugger.
+ */
+
+#ifndef USB_TRACE_H
+#define USB_TRACE_H
+
+#include <stdint.h>
+
+// trace events, the numbers must match tools/trace_decode.py
+typedef enum {
+	TR_NONE,
+	TR_RESET,			// USB bus reset
+	TR_SUSPEND,
+	TR_WAKEUP,
+	TR_SETUP,			// len = (bmRequestType<<8) | bRequest
+	TR_CTRL_OUT,
+	TR_CTRL_IN,
+	TR_BULK_OUT,		// len = number of received bytes
+	TR_BULK_IN,
+	TR_RX,				// packet read from PMA, len = number of bytes
+	TR_TX,				// packet written to PMA, len = number of bytes
+	TR_STALL,			// ep = EP address
+	TR_UNSTALL,			// ep = EP address
+	TR_SET_ADDRESS,		// len = device address
+	TR_SET_CONFIG,		// len = configuration value
+	TR_HEADER,			// valid command header received, len = command id
+	TR_ERROR,			// len = error code
+	TR_ERASE_START,		// len = page number
+	TR_ERASE_END,
+	TR_WRITE_START,		// len = number of bytes
+	TR_WRITE_END,
+	TR_COMPLETE,		// all pages written, len = number of pages
+	TR_FRAME,			// end of a frame with EP_DATA traffic, len = number of bytes
+	TR_VERIFY_FAIL,		// flash read back wrong, len = offset in the page
+	TR_LAST
+} trace_event_t;
+
+#ifdef USB_DEBUG
+
+#include "dwt.h"
+
+// one trace record, 8 bytes
+typedef struct trace_rec_t {
+	uint32_t cycles;	// DWT cycle counter
+	uint8_t event;		// trace_event_t
+	uint8_t ep;			// endpoint number or address
+	uint16_t len;		// event specific value
+} trace_rec_t;
+
+// number of records, must be a power of 2
+#define TRACE_SIZE	1024
+
+extern trace_rec_t trace_buf[TRACE_SIZE];
+extern uint32_t trace_cnt; // total number of logged events, also counting the overwritten ones
+
+extern void TraceInit(void);
+extern void TraceDump(void);
+
+//-----------------------------------------------------------------------------
+static inline void TraceEvent(uint8_t event, uint8_t ep, uint16_t len)
+{
+	uint32_t primask;
+	asm volatile ("mrs %0, primask\n cpsid i" : "=r" (primask) : : "memory");
+
+	trace_rec_t * rec = &trace_buf[trace_cnt++ & (TRACE_SIZE-1)];
+	rec->cycles = dwt_cycles();
+	rec->event = event;
+	rec->ep = ep;
+	rec->len = len;
+
+	asm volatile ("msr primask, %0" : : "r" (primask) : "memory");
+}
+
+#define etrace(ev,ep,len)	TraceEvent(ev, ep, len)
+
+#else
+
+#define etrace(ev,ep,len)
+
+#endif
+
+#endif // USB_TRACE_H
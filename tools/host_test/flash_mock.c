@@ -0,0 +1,122 @@
+/*
+ * flash_mock.c
+ *
+ * Host test: flash controller, see flash_mock.h
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include "usb_func.h"
+#include "flash_mock.h"
+
+flash_reg_map flash_regs;
+uint32_t flash_mock_erases;
+uint32_t flash_mock_writes;
+uint32_t flash_mock_pgerr;
+uint32_t flash_mock_weak_addr;
+
+static bool locked = true;
+static bool irq_pending;
+static uint32_t op_err;
+
+extern void FLASH_IRQHandler(void);
+
+//-----------------------------------------------------------------------------
+// the flash at its address, the sources keep addresses in uint32_t
+//-----------------------------------------------------------------------------
+void Flash_mock_init(void)
+{
+	static bool mapped;
+	if ( !mapped )
+	{
+		void * p = mmap((void *)(uintptr_t)FLASH_BASE, FLASH_SIZE, PROT_READ | PROT_WRITE,
+						MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+		if ( p != (void *)(uintptr_t)FLASH_BASE )
+		{
+			perror("mmap of the flash");
+			exit(2);
+		}
+		mapped = true;
+	}
+	memset((void *)(uintptr_t)FLASH_BASE, 0xFF, FLASH_SIZE);
+	flash_mock_erases = flash_mock_writes = flash_mock_pgerr = 0;
+	flash_mock_weak_addr = 0;
+	irq_pending = false;
+	locked = true;
+}
+//-----------------------------------------------------------------------------
+static void Op_end(uint32_t err)
+{
+	op_err = err;
+	if ( flash_regs.CR & FLASH_CR_EOPIE )
+		irq_pending = true;
+}
+//-----------------------------------------------------------------------------
+void flash_unlock(void)
+{
+	locked = false;
+}
+//-----------------------------------------------------------------------------
+void flash_lock(void)
+{
+	locked = true;
+}
+//-----------------------------------------------------------------------------
+void flash_erase_start(uint32_t addr)
+{
+	if ( locked )
+	{
+		Op_end(FLASH_ERR_WRP);
+		return;
+	}
+	memset((void *)(uintptr_t)(addr & ~(PAGE_SIZE-1)), 0xFF, PAGE_SIZE);
+	flash_mock_erases++;
+	Op_end(0);
+}
+//-----------------------------------------------------------------------------
+void flash_program_start(uint32_t addr, uint16_t value)
+{
+	volatile uint16_t * p = (volatile uint16_t *)(uintptr_t)addr;
+	if ( locked )
+	{
+		Op_end(FLASH_ERR_WRP);
+		return;
+	}
+	if ( *p != 0xFFFF && value != 0 )
+	{
+		flash_mock_pgerr++;
+		Op_end(FLASH_ERR_PG);
+		return;
+	}
+	*p = value;
+	if ( addr==flash_mock_weak_addr )
+	{	// a weak cell, found by the read-back
+		*p = value ^ 1;
+		flash_mock_weak_addr = 0;
+	}
+	flash_mock_writes++;
+	Op_end(0);
+}
+//-----------------------------------------------------------------------------
+uint32_t flash_poll(void)
+{
+	uint32_t err = op_err;
+	op_err = 0;
+	return err;
+}
+//-----------------------------------------------------------------------------
+uint32_t flash_await(void)
+{
+	return flash_poll();
+}
+//-----------------------------------------------------------------------------
+void Flash_mock_run(void)
+{
+	while ( irq_pending )
+	{
+		irq_pending = false;
+		FLASH_IRQHandler();
+	}
+}
@@ -0,0 +1,24 @@
+/*
+ * flash_mock.h
+ *
+ * Host test: flash controller with the F1/F3 rules. An erase sets the page
+ * to 0xFF, a half-word can only be programmed when erased, or to 0. Each
+ * operation ends at once and raises the FLASH interrupt, Flash_mock_run()
+ * calls FLASH_IRQHandler() till no operation is pending.
+ */
+
+#ifndef FLASH_MOCK_H
+#define FLASH_MOCK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+extern uint32_t flash_mock_erases;		// pages erased
+extern uint32_t flash_mock_writes;		// half-words programmed
+extern uint32_t flash_mock_pgerr;		// programs of a non-erased half-word
+extern uint32_t flash_mock_weak_addr;	// next program there reads back wrong, 0 = none
+
+extern void Flash_mock_init(void);
+extern void Flash_mock_run(void);
+
+#endif // FLASH_MOCK_H
@@ -0,0 +1,15 @@
+/*
+ * nvic.h
+ *
+ * Host test: the FLASH interrupt is raised by flash_mock.c
+ */
+
+#ifndef NVIC_H
+#define NVIC_H
+
+#define NVIC_FLASH			4
+
+static inline void nvic_irq_enable(int irq) { (void)irq; }
+static inline void nvic_irq_disable(int irq) { (void)irq; }
+
+#endif // NVIC_H
@@ -0,0 +1,104 @@
+/*
+ * usb_def.h
+ *
+ * Host test: the USB device of F1 with its registers and packet memory in
+ * the host RAM, see usb_mock.c. The bit names are the ones of
+ * F1/eclipse_project/src/usb_def.h, the buffer layout is taken from
+ * F3/eclipse_project/src/usb_pma.h. PMA_2X16 selects the packet memory of
+ * the STM32F303xE (2 x 16 bit per word).
+ */
+
+#ifndef USB_DEF_H
+#define USB_DEF_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "usb_traits.h"
+
+#define NAME_OF_USB_IRQ_HANDLER USB_LP_CAN_RX0_IRQHandler
+
+#define USB_FRAME_STATS 0
+#define USB_KEEP_ON_HANDOFF 0
+
+#define trace(...)
+#define ntrace(d,nl)
+#define strace(...)
+
+//-----------------------------------------------------------------------------
+// EPnR and ISTR have toggle and clear-by-0 bits, so each access goes through
+// Usb_mock_reg(): it returns a latch holding the register value, a value
+// stored into the latch is applied with the rules of the hardware at the
+// next access (or Usb_mock_sync). The other registers are plain variables.
+//-----------------------------------------------------------------------------
+enum { USB_MOCK_EP0R, USB_MOCK_ISTR = 8, USB_MOCK_LATCHED };
+
+extern volatile usb_reg_t * Usb_mock_reg(int reg);
+extern usb_reg_t usb_mock_cntr, usb_mock_fnr, usb_mock_daddr, usb_mock_btable;
+
+#define USB_EpRegs(x) (*Usb_mock_reg(USB_MOCK_EP0R + (x)))
+#define USB_EP0R      USB_EpRegs(0)
+#define USB_EP1R      USB_EpRegs(1)
+#define USB_EP2R      USB_EpRegs(2)
+
+#define USB_CNTR      usb_mock_cntr
+#define USB_ISTR      (*Usb_mock_reg(USB_MOCK_ISTR))
+#define USB_FNR       usb_mock_fnr
+#define USB_DADDR     usb_mock_daddr
+#define USB_BTABLE    usb_mock_btable
+
+/* Control register (USB_CNTR) */
+#define USB_CNTR_CTRM                  (1<<15)
+#define USB_CNTR_PMAOVERM              (1<<14)
+#define USB_CNTR_ERRM                  (1<<13)
+#define USB_CNTR_WKUPM                 (1<<12)
+#define USB_CNTR_SUSPM                 (1<<11)
+#define USB_CNTR_RESETM                (1<<10)
+#define USB_CNTR_SOFM                  (1<<9)
+#define USB_CNTR_ESOFM                 (1<<8)
+#define USB_CNTR_RESUME                (1<<4)
+#define USB_CNTR_FSUSP                 (1<<3)
+#define USB_CNTR_LP_MODE               (1<<2)
+#define USB_CNTR_PDWN                  (1<<1)
+#define USB_CNTR_FRES                  (1<<0)
+
+/* Bits in USB_ISTR */
+#define  DIR      (1<<4)
+#define  ESOF     (1<<8)
+#define  SOF      (1<<9)
+#define  RESET    (1<<10)
+#define  SUSP     (1<<11)
+#define  WKUP     (1<<12)
+#define  ERR      (1<<13)
+#define  PMAOVR   (1<<14)
+#define  CTR      (1<<15)
+
+/* Bits in den USB_EPnR */
+#define  CTR_RX   (1<<15)
+#define  DTOG_RX  (1<<14)
+#define  STAT_RX  (3<<12)
+#define  SETUP    (1<<11)
+#define  EP_TYPE  (3<<9)
+#define  EP_KIND  (1<<8)
+#define  CTR_TX   (1<<7)
+#define  DTOG_TX  (1<<6)
+#define  STAT_TX  (3<<4)
+#define  MASK_EP  (15)
+
+/* Bits in USB_FNR */
+#define  FNR_FN   (0x7FF)
+
+/* EndPoint Register Mask (No Toggle Fields) */
+#define  EP_MASK_NoToggleBits  (CTR_RX|SETUP|EP_TYPE|EP_KIND|CTR_TX|MASK_EP)
+
+//-----------------------------------------------------------------------------
+// packet memory
+//-----------------------------------------------------------------------------
+#define USB_PMA_SIZE	1024	// bytes of the address space
+extern uint8_t usb_pma[USB_PMA_SIZE];
+
+#define USB_PMAADDR			((uintptr_t)usb_pma)
+#define STM32_USB_PMA_2X16	PMA_2X16
+
+#include "../../../F3/eclipse_project/src/usb_pma.h"
+
+#endif // USB_DEF_H
@@ -0,0 +1,81 @@
+/*
+ * usb_func.h
+ *
+ * Host test: the family definitions used by the common sources, with the
+ * F1 flash (1 kB pages, half-word programming) and USB device. The flash is
+ * mapped at FLASH_BASE, see flash_mock.c, the USB device in usb_mock.c.
+ */
+
+#ifndef USB_FUNC_H
+#define USB_FUNC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "usb_def.h"
+#include "usb_desc.h"
+
+#define __ramfunc
+
+#define PAGE_SIZE			1024
+#define FLASH_BASE			0x08000000
+#define FLASH_SIZE			(64 * 1024)
+
+#define etrace(ev,ep,len)
+
+extern uint32_t upload_base;
+
+//-----------------------------------------------------------------------------
+// flash controller, see flash_mock.c
+//-----------------------------------------------------------------------------
+typedef struct {
+	uint32_t CR;
+} flash_reg_map;
+extern flash_reg_map flash_regs;
+#define FLASH				(&flash_regs)
+#define FLASH_CR_EOPIE		(1<<12)
+
+#define FLASH_BUSY			(1<<0)
+#define FLASH_ERR_PG		(1<<1)
+#define FLASH_ERR_WRP		(1<<2)
+
+extern void flash_unlock(void);
+extern void flash_lock(void);
+extern void flash_erase_start(uint32_t addr);
+extern void flash_program_start(uint32_t addr, uint16_t value);
+extern uint32_t flash_poll(void);
+extern uint32_t flash_await(void);
+
+static inline uint32_t dwt_cycles(void) { return 0; }
+
+//-----------------------------------------------------------------------------
+// USB device state, the fields used by common/usb.c
+//-----------------------------------------------------------------------------
+typedef struct
+{
+	int transferLen;
+	int packetLen;
+	uint8_t* transferPtr;
+	int configuration;
+} command_t;
+
+typedef union status_t {
+	uint16_t both;
+	struct {
+		uint8_t suspended;
+		uint8_t configured;
+	};
+} status_t;
+
+extern command_t CMD;
+extern status_t usb_state;
+
+extern int SendData(int ep, uint8_t* pBuffer, int count);
+extern void NAME_OF_USB_IRQ_HANDLER(void);
+
+static inline void USB_SetAddress(uint8_t adr)
+{
+	USB_DADDR = 0x80 | adr;
+}
+
+#endif // USB_FUNC_H
@@ -0,0 +1,13 @@
+/*
+ * usb_std.h
+ *
+ * Host test: the endpoint addresses used by the USB driver
+ */
+
+#ifndef USB_STD_H
+#define USB_STD_H
+
+#define USB_EP_ADDR_OUT(x)	(x)
+#define USB_EP_ADDR_IN(x)	(0x80 | (x))
+
+#endif // USB_STD_H
@@ -0,0 +1,18 @@
+/*
+ * usb_traits.h
+ *
+ * Host test: the traits of F1 (32 bit register access), the bit names are
+ * defined in the mock usb_def.h. The packet memory is the one of F3, see
+ * F3/eclipse_project/src/usb_pma.h.
+ */
+
+#ifndef MOCK_USB_TRAITS_H
+#define MOCK_USB_TRAITS_H
+
+#include "../../../F1/eclipse_project/src/usb_traits.h"
+
+// set by usb_pma.h
+#undef UMEM_SHIFT
+#undef UMEM_FAKEWIDTH
+
+#endif // MOCK_USB_TRAITS_H
@@ -0,0 +1,25 @@
+/*
+ * test.h
+ *
+ * Host test: minimal checks, a failed check is printed and counted
+ */
+
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdio.h>
+
+extern int test_failed;
+
+#define CHECK(cond) \
+	do { \
+		if ( !(cond) ) { \
+			printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+			test_failed++; \
+		} \
+	} while (0)
+
+#define TEST_END(name) \
+	(printf("%s: %s\n", name, test_failed ? "FAILED" : "ok"), test_failed ? 1 : 0)
+
+#endif // TEST_H
@@ -0,0 +1,143 @@
+/*
+ * test_flash_engine.c
+ *
+ * Host test of common/flash_engine.c: uploads, patches and the retry of a
+ * page failing the verify, on the flash mock.
+ */
+
+#include <string.h>
+#include "usb_func.h"
+#include "flash_engine.h"
+#include "flash_mock.h"
+#include "test.h"
+
+int test_failed;
+uint32_t upload_base = FLASH_BASE;
+
+void OnFlashJobDone(void)
+{
+}
+
+#define PAGE(n)			(FLASH_BASE + (n) * PAGE_SIZE)
+#define AT(addr)		((const uint8_t *)(uintptr_t)(addr))
+
+//-----------------------------------------------------------------------------
+// the page of a CMD_PAGE: erase, then the packets
+//-----------------------------------------------------------------------------
+static void Upload_page(uint32_t page, uint8_t fill, int len)
+{
+	Flash_queue_erase(page);
+	for (int pos = 0; pos < len; pos += EP_DATA_LEN)
+	{
+		int n = (len - pos < EP_DATA_LEN) ? len - pos : EP_DATA_LEN;
+		uint8_t * buf = Flash_job_buffer();
+		CHECK(buf != NULL);
+		memset(buf, fill + pos / EP_DATA_LEN, n);
+		Flash_queue_write(page + pos, n);
+		Flash_mock_run();
+	}
+}
+//-----------------------------------------------------------------------------
+static void Patch(uint32_t addr, const void * data, int len)
+{
+	CHECK(Flash_engine_idle());
+	memcpy(Flash_job_buffer(), data, len);
+	CHECK(Flash_queue_patch(addr, len));
+	Flash_mock_run();
+	CHECK(Flash_engine_idle());
+	CHECK(memcmp(AT(addr), data, len)==0);
+}
+//-----------------------------------------------------------------------------
+static void Test_upload(void)
+{
+	Flash_mock_init();
+	Flash_engine_start();
+	for (int n = 0; n < 4; n++)
+		Upload_page(PAGE(n), 0x10 * n, PAGE_SIZE);
+	Flash_mock_run();
+	CHECK(Flash_engine_idle());
+	CHECK(flash_errors==0 && flash_mock_pgerr==0);
+	CHECK(AT(PAGE(2))[0]==0x20 && AT(PAGE(2))[PAGE_SIZE-1]==0x20 + PAGE_SIZE/EP_DATA_LEN - 1);
+	Flash_engine_stop();
+}
+//-----------------------------------------------------------------------------
+// bytes into erased half-words are written without an erase
+//-----------------------------------------------------------------------------
+static void Test_patch_blank(void)
+{
+	Flash_mock_init();
+	Flash_engine_start();
+	Upload_page(PAGE(1), 0x40, 100);
+	uint32_t erases = flash_mock_erases;
+	const uint8_t data[] = {1, 2, 3, 4, 5};
+	Patch(PAGE(1) + 101, data, sizeof(data)); // odd start, the half-word at 100 is written
+	CHECK(flash_mock_erases==erases);
+	CHECK(AT(PAGE(1))[99]==0x41 && AT(PAGE(1))[100]==0xFF && AT(PAGE(1))[106]==0xFF);
+	CHECK(flash_errors==0 && flash_mock_pgerr==0);
+	Flash_engine_stop();
+}
+//-----------------------------------------------------------------------------
+// the same page patched three times with an erase each, the page copies of
+// both slots then hold this page
+//-----------------------------------------------------------------------------
+static void Test_patch_same_page(void)
+{
+	Flash_mock_init();
+	Flash_engine_start();
+	Upload_page(PAGE(3), 0x50, PAGE_SIZE);
+	for (int i = 0; i < 3; i++)
+	{
+		uint32_t erases = flash_mock_erases;
+		uint8_t data[6];
+		memset(data, 0xA0 + i, sizeof(data));
+		Patch(PAGE(3) + 200, data, sizeof(data));
+		CHECK(flash_mock_erases==erases + 1);
+		CHECK(AT(PAGE(3))[199]==0x53 && AT(PAGE(3))[206]==0x53 && AT(PAGE(3))[PAGE_SIZE-1]==0x5F);
+	}
+	CHECK(flash_errors==0 && flash_mock_pgerr==0);
+	Flash_engine_stop();
+}
+//-----------------------------------------------------------------------------
+// a patch into the last page of an upload, while its copy is still in a slot
+//-----------------------------------------------------------------------------
+static void Test_patch_after_upload(void)
+{
+	Flash_mock_init();
+	Flash_engine_start();
+	Upload_page(PAGE(5), 0x60, PAGE_SIZE);
+	Upload_page(PAGE(6), 0x70, PAGE_SIZE/2);
+	const uint8_t a[] = {0xDE, 0xAD};
+	const uint8_t b[] = {0xBE, 0xEF};
+	Patch(PAGE(6) + 10, a, sizeof(a)); // programmed before, erase
+	Patch(PAGE(6) + PAGE_SIZE - 2, b, sizeof(b)); // erased before
+	CHECK(AT(PAGE(6))[0]==0x70 && AT(PAGE(6))[PAGE_SIZE/2-1]==0x77 && AT(PAGE(6))[PAGE_SIZE/2]==0xFF);
+	CHECK(memcmp(AT(PAGE(6) + 10), a, sizeof(a))==0);
+	CHECK(flash_errors==0 && flash_mock_pgerr==0);
+	Flash_engine_stop();
+}
+//-----------------------------------------------------------------------------
+// a patch failing the verify: the retry erases the page and writes it all
+// again, not only up to the patched bytes
+//-----------------------------------------------------------------------------
+static void Test_patch_retry(void)
+{
+	Flash_mock_init();
+	Flash_engine_start();
+	Upload_page(PAGE(2), 0x30, PAGE_SIZE);
+	const uint8_t data[] = {0x11, 0x22, 0x33, 0x44};
+	flash_mock_weak_addr = PAGE(2) + 20;
+	Patch(PAGE(2) + 20, data, sizeof(data));
+	CHECK(flash_retries==1 && flash_errors==0);
+	CHECK(AT(PAGE(2))[PAGE_SIZE-1]==0x3F && AT(PAGE(2))[19]==0x30);
+	Flash_engine_stop();
+}
+//-----------------------------------------------------------------------------
+int main(void)
+{
+	Test_upload();
+	Test_patch_blank();
+	Test_patch_same_page();
+	Test_patch_after_upload();
+	Test_patch_retry();
+	return TEST_END("flash_engine");
+}
@@ -0,0 +1,291 @@
+/*
+ * test_usb.c
+ *
+ * Host test of common/usb.c on the USB device mock: bus reset, the dispatch
+ * of the endpoint interrupts by NAME_OF_USB_IRQ_HANDLER, the endpoint
+ * state changes of usb_ep.h and the packet memory access. Built for both
+ * access schemes of the packet memory, see mock/usb_traits.h.
+ */
+
+#include <string.h>
+#include "usb_std.h"
+#include "usb_func.h"
+#include "usb_cmd.h"
+#include "usb_ep.h"
+#include "usb_mock.h"
+#include "test.h"
+
+int test_failed;
+command_t CMD;
+status_t usb_state;
+uint8_t deviceAddress;
+
+// calls of the class code
+static int setups, ctrl_outs, ctrl_ins, bulk_outs, bulk_ins;
+
+void OnSetup(void) { setups++; }
+void OnEpCtrlOut(void) { ctrl_outs++; }
+void OnEpCtrlIn(void) { ctrl_ins++; }
+void OnEpBulkOut(void) { bulk_outs++; }
+void OnEpBulkIn(void) { bulk_ins++; }
+
+// used inside usb.c only
+extern void MarkBufferTxReady(int ep);
+extern void UnStall_EPAddr(int epNum);
+
+#define STAT_TX_OF(epr)	((epr) & STAT_TX)
+
+//-----------------------------------------------------------------------------
+static void Irq(void)
+{
+	NAME_OF_USB_IRQ_HANDLER();
+	Usb_mock_sync();
+}
+//-----------------------------------------------------------------------------
+// bus reset: the EP table, the endpoint registers and the interrupt mask
+//-----------------------------------------------------------------------------
+static void Test_reset(void)
+{
+	Usb_mock_init();
+	usb_mock_istr = RESET;
+	Irq();
+	CHECK(usb_mock_istr==0);
+	CHECK(USB_BTABLE==EP_TABLE_OFFSET && USB_DADDR==0x80);
+	CHECK(USB_CNTR==(USB_CNTR_CTRM | USB_CNTR_RESETM | USB_CNTR_SUSPM | USB_CNTR_WKUPM));
+	CHECK(EpTable[EP_DATA].txOffset==EP_DATA_TX_OFFSET && EpTable[EP_DATA].rxOffset==EP_DATA_RX_OFFSET);
+	CHECK(EpTable[EP_CTRL].rxCount==EP_RX_LEN_ID && EpTable[EP_COMM].txCount==0);
+	CHECK(usb_mock_epr[EP_CTRL]==(USB_EP_RX_VALID | USB_EP_TX_NAK | (1<<9) | EP_CTRL));
+	CHECK(usb_mock_epr[EP_DATA]==(USB_EP_RX_VALID | USB_EP_TX_NAK | (0<<9) | EP_DATA));
+	CHECK(usb_mock_epr[EP_COMM]==(USB_EP_RX_VALID | USB_EP_TX_NAK | (3<<9) | EP_COMM));
+	CHECK(usb_mock_rmw==0);
+}
+//-----------------------------------------------------------------------------
+// completed transfers: each one is passed to the class code once, its CTR bit
+// is cleared, the state of the endpoint is kept
+//-----------------------------------------------------------------------------
+static void Test_dispatch(void)
+{
+	Test_reset();
+	uint16_t data = usb_mock_epr[EP_DATA];
+
+	usb_mock_epr[EP_CTRL] |= CTR_RX | SETUP;
+	Irq();
+	CHECK(setups==1 && ctrl_outs==0);
+	CHECK((usb_mock_epr[EP_CTRL] & CTR_RX)==0);
+
+	usb_mock_epr[EP_CTRL] &= ~SETUP;
+	usb_mock_epr[EP_CTRL] |= CTR_RX;
+	Irq();
+	CHECK(setups==1 && ctrl_outs==1);
+
+	// both directions of EP_DATA completed, served in one interrupt
+	usb_mock_epr[EP_DATA] |= CTR_RX | CTR_TX;
+	Irq();
+	CHECK(bulk_outs==1 && bulk_ins==1);
+	CHECK(usb_mock_epr[EP_DATA]==data);
+
+	// the address is applied after the status stage on EP_CTRL
+	deviceAddress = 5;
+	usb_mock_epr[EP_CTRL] |= CTR_TX;
+	Irq();
+	CHECK(ctrl_ins==1 && deviceAddress==0 && USB_DADDR==(0x80 | 5));
+	CHECK((usb_mock_epr[EP_CTRL] & (CTR_RX | CTR_TX))==0);
+	CHECK(usb_mock_rmw==0);
+}
+//-----------------------------------------------------------------------------
+// EpSetStatRx/Tx from each state to each state: only the STAT field changes,
+// a CTR bit set by the hardware between the load and the store is kept
+//-----------------------------------------------------------------------------
+static void Test_ep_stat(void)
+{
+	static const uint16_t others[] = { 0, DTOG_RX | DTOG_TX, CTR_RX | CTR_TX | DTOG_TX, EP_KIND | (3<<9) };
+	const int ep = EP_COMM;
+	Usb_mock_init();
+	for (unsigned o = 0; o < sizeof(others)/sizeof(others[0]); o++)
+		for (int from = 0; from < 4; from++)
+			for (int to = 0; to < 4; to++)
+			{
+				uint16_t base = others[o] | ep;
+				usb_mock_epr[ep] = base | (from<<12) | ((3-from)<<4);
+				EpSetStatRx(ep, to<<12);
+				Usb_mock_sync();
+				CHECK(usb_mock_epr[ep]==(base | (to<<12) | ((3-from)<<4)));
+
+				usb_mock_epr[ep] = base | ((3-from)<<12) | (from<<4);
+				EpSetStatTx(ep, to<<4);
+				Usb_mock_sync();
+				CHECK(usb_mock_epr[ep]==(base | ((3-from)<<12) | (to<<4)));
+			}
+
+	usb_mock_epr[ep] = USB_EP_RX_NAK | USB_EP_TX_NAK | ep;
+	usb_mock_ctr_set[ep] = CTR_RX;
+	EpSetStatTx(ep, USB_EP_TX_VALID);
+	Usb_mock_sync();
+	CHECK(usb_mock_epr[ep]==(CTR_RX | USB_EP_RX_NAK | USB_EP_TX_VALID | ep));
+	usb_mock_ctr_set[ep] = CTR_TX;
+	EpSetStatRx(ep, USB_EP_RX_VALID);
+	Usb_mock_sync();
+	CHECK(usb_mock_epr[ep]==(CTR_RX | CTR_TX | USB_EP_RX_VALID | USB_EP_TX_VALID | ep));
+	CHECK(usb_mock_rmw==0);
+}
+//-----------------------------------------------------------------------------
+// EpClearCtrRx/Tx clear only their CTR bit, also if the other one is set meanwhile
+//-----------------------------------------------------------------------------
+static void Test_ep_ctr(void)
+{
+	const int ep = EP_DATA;
+	const uint16_t state = DTOG_RX | USB_EP_RX_NAK | DTOG_TX | USB_EP_TX_VALID | ep;
+	Usb_mock_init();
+
+	usb_mock_epr[ep] = CTR_RX | CTR_TX | state;
+	EpClearCtrRx(ep, usb_mock_epr[ep]);
+	Usb_mock_sync();
+	CHECK(usb_mock_epr[ep]==(CTR_TX | state));
+	EpClearCtrTx(ep, usb_mock_epr[ep]);
+	Usb_mock_sync();
+	CHECK(usb_mock_epr[ep]==state);
+
+	usb_mock_epr[ep] = CTR_RX | state;
+	usb_mock_ctr_set[ep] = CTR_TX;
+	EpClearCtrRx(ep, usb_mock_epr[ep]);
+	Usb_mock_sync();
+	CHECK(usb_mock_epr[ep]==(CTR_TX | state));
+
+	usb_mock_ctr_set[ep] = CTR_RX;
+	EpClearCtrTx(ep, usb_mock_epr[ep]);
+	Usb_mock_sync();
+	CHECK(usb_mock_epr[ep]==(CTR_RX | state));
+	CHECK(usb_mock_rmw==0);
+}
+//-----------------------------------------------------------------------------
+// an IN address stalls the TX side, an OUT address the RX side. Unstalled,
+// an IN endpoint NAKs till data is written, an OUT endpoint receives.
+//-----------------------------------------------------------------------------
+static void Test_stall(void)
+{
+	const int ep = EP_DATA;
+	const uint16_t keep = DTOG_RX | DTOG_TX | ep;
+	Test_reset();
+	usb_mock_epr[ep] |= DTOG_RX | DTOG_TX;
+
+	Stall_EPAddr(EP_DATA_ADDR_IN);
+	Usb_mock_sync();
+	CHECK(usb_mock_epr[ep]==(keep | USB_EP_RX_VALID | USB_EP_TX_STALL));
+	UnStall_EPAddr(EP_DATA_ADDR_IN);
+	Usb_mock_sync();
+	CHECK(usb_mock_epr[ep]==(keep | USB_EP_RX_VALID | USB_EP_TX_NAK));
+
+	Stall_EPAddr(EP_DATA_ADDR_OUT);
+	Usb_mock_sync();
+	CHECK(usb_mock_epr[ep]==(keep | USB_EP_RX_STALL | USB_EP_TX_NAK));
+	UnStall_EPAddr(EP_DATA_ADDR_OUT);
+	Usb_mock_sync();
+	CHECK(usb_mock_epr[ep]==(keep | USB_EP_RX_VALID | USB_EP_TX_NAK));
+
+	MarkBufferTxReady(ep);
+	Stall(ep);
+	Usb_mock_sync();
+	CHECK(usb_mock_epr[ep]==(keep | USB_EP_RX_STALL | USB_EP_TX_STALL));
+	UnStall(ep);
+	Usb_mock_sync();
+	CHECK(usb_mock_epr[ep]==(keep | USB_EP_RX_VALID | USB_EP_TX_NAK));
+
+	MarkBufferTxReady(ep);
+	Usb_mock_sync();
+	CHECK(usb_mock_epr[ep]==(keep | USB_EP_RX_VALID | USB_EP_TX_VALID));
+	EpSetStatRx(ep, USB_EP_RX_NAK);
+	MarkBufferRxDone(ep);
+	Usb_mock_sync();
+	CHECK(usb_mock_epr[ep]==(keep | USB_EP_RX_VALID | USB_EP_TX_VALID));
+	CHECK(usb_mock_rmw==0);
+}
+//-----------------------------------------------------------------------------
+// the EP table as read by the USB core: 4 half-words per endpoint at BTABLE
+//-----------------------------------------------------------------------------
+static uint16_t Table_word(int ep, int n)
+{
+	int i = USB_BTABLE + ep * 8 + n * 2;
+	return PMA_BYTE(i) | (PMA_BYTE(i + 1) << 8);
+}
+//-----------------------------------------------------------------------------
+static void Test_pma_table(void)
+{
+	Test_reset();
+	CHECK(Table_word(EP_DATA, 0)==EP_DATA_TX_OFFSET && Table_word(EP_DATA, 2)==EP_DATA_RX_OFFSET);
+	CHECK(Table_word(EP_COMM, 0)==EP_COMM_TX_OFFSET && Table_word(EP_COMM, 3)==EP_RX_LEN_ID);
+	EpTable[EP_DATA].txCount = 37;
+	CHECK(Table_word(EP_DATA, 1)==37);
+}
+//-----------------------------------------------------------------------------
+// SendData: each length up to one more than the buffer, the bytes after the
+// packet (the next buffer) are not touched
+//-----------------------------------------------------------------------------
+static void Test_pma_send(void)
+{
+	uint8_t src[EP_DATA_LEN + 2];
+	for (unsigned i = 0; i < sizeof(src); i++)
+		src[i] = 0x40 + i;
+	Test_reset();
+	for (int count = 0; count <= EP_DATA_LEN + 1; count++)
+	{
+		for (int i = 0; i < 2 * EP_DATA_LEN; i++)
+			PMA_BYTE(EP_DATA_TX_OFFSET + i) = 0xEE;
+		int sent = SendData(EP_DATA, src, count);
+		int len = (count < EP_DATA_LEN) ? count : EP_DATA_LEN;
+		CHECK(sent==len);
+		CHECK((int)(EpTable[EP_DATA].txCount & 0x3FF)==len);
+		int bad = 0;
+		for (int i = 0; i < len; i++)
+			bad += PMA_BYTE(EP_DATA_TX_OFFSET + i) != src[i];
+		for (int i = (len + 1) & ~1; i < 2 * EP_DATA_LEN; i++)
+			bad += PMA_BYTE(EP_DATA_TX_OFFSET + i) != 0xEE;
+		CHECK(bad==0);
+	}
+	Usb_mock_sync();
+	CHECK(STAT_TX_OF(usb_mock_epr[EP_DATA])==USB_EP_TX_VALID);
+}
+//-----------------------------------------------------------------------------
+// ReadData: each received length, limited by the given count. Nothing is
+// written after the requested bytes, also not for an odd length.
+//-----------------------------------------------------------------------------
+static void Test_pma_read(void)
+{
+	uint8_t dest[EP_DATA_LEN + 4];
+	Test_reset();
+	for (int i = 0; i < EP_DATA_LEN; i++)
+		PMA_BYTE(EP_DATA_RX_OFFSET + i) = 0x80 + i;
+	for (int rxd = 1; rxd <= EP_DATA_LEN; rxd++)
+	{
+		EpTable[EP_DATA].rxCount = EP_RX_LEN_ID | rxd;
+		CHECK(Ep_rx_count(EP_DATA)==rxd);
+		for (int count = rxd - 1; count <= rxd + 1; count++)
+		{
+			memset(dest, 0xEE, sizeof(dest));
+			ReadData(EP_DATA, dest, count);
+			int len = (count < rxd) ? count : rxd;
+			int bad = 0;
+			for (int i = 0; i < len; i++)
+				bad += dest[i] != 0x80 + i;
+			for (unsigned i = len; i < sizeof(dest); i++)
+				bad += dest[i] != 0xEE;
+			CHECK(bad==0);
+		}
+	}
+}
+//-----------------------------------------------------------------------------
+int main(void)
+{
+	Test_reset();
+	Test_dispatch();
+	Test_ep_stat();
+	Test_ep_ctr();
+	Test_stall();
+	Test_pma_table();
+	Test_pma_send();
+	Test_pma_read();
+#if PMA_2X16
+	return TEST_END("usb 2x16");
+#else
+	return TEST_END("usb 1x16");
+#endif
+}
@@ -0,0 +1,99 @@
+/*
+ * usb_mock.c
+ *
+ * Host test: USB device registers and packet memory, see usb_mock.h
+ */
+
+#include <string.h>
+#include "usb_func.h"
+#include "usb_mock.h"
+
+uint8_t usb_pma[USB_PMA_SIZE] __attribute__((aligned(4)));
+usb_reg_t usb_mock_cntr, usb_mock_fnr, usb_mock_daddr, usb_mock_btable;
+
+uint16_t usb_mock_epr[8];
+uint16_t usb_mock_istr;
+uint16_t usb_mock_ctr_set[8];
+int usb_mock_rmw;
+
+#define ISTR_FLAGS		(ESOF | SOF | RESET | SUSP | WKUP | ERR | PMAOVR)
+#define EPR_RW			(EP_TYPE | EP_KIND | MASK_EP)
+#define EPR_TOGGLE		(DTOG_RX | STAT_RX | DTOG_TX | STAT_TX)
+
+// the upper half of a latch holds this mark till a value is stored
+#define LATCH_MARK		0x5A5A0000
+
+static volatile usb_reg_t latch[USB_MOCK_LATCHED];
+static uint16_t latch_read[USB_MOCK_LATCHED]; // the value read through the latch
+static uint32_t latch_used; // bit n: latch[n] was handed out
+
+//-----------------------------------------------------------------------------
+void Usb_mock_init(void)
+{
+	memset(usb_pma, 0, sizeof(usb_pma));
+	memset(usb_mock_epr, 0, sizeof(usb_mock_epr));
+	memset(usb_mock_ctr_set, 0, sizeof(usb_mock_ctr_set));
+	usb_mock_istr = 0;
+	usb_mock_rmw = 0;
+	usb_mock_cntr = USB_CNTR_FRES | USB_CNTR_PDWN;
+	usb_mock_fnr = usb_mock_daddr = usb_mock_btable = 0;
+	latch_used = 0;
+}
+//-----------------------------------------------------------------------------
+// ISTR: the flags, and the endpoint with the lowest number having a CTR bit
+//-----------------------------------------------------------------------------
+static uint16_t Istr_read(void)
+{
+	uint16_t val = usb_mock_istr & ISTR_FLAGS;
+	for (int ep = 0; ep < 8; ep++)
+	{
+		uint16_t epr = usb_mock_epr[ep];
+		if ( epr & (CTR_RX | CTR_TX) )
+		{
+			val |= CTR | ep | ((epr & CTR_RX) ? DIR : 0);
+			break;
+		}
+	}
+	return val;
+}
+//-----------------------------------------------------------------------------
+static void Store(int reg, uint16_t val)
+{
+	if ( reg==USB_MOCK_ISTR )
+	{	// CTR, DIR and EP_ID are read only
+		usb_mock_istr &= val;
+		return;
+	}
+	int ep = reg - USB_MOCK_EP0R;
+	// a transfer completed after the register was read
+	uint16_t old = usb_mock_epr[ep] | usb_mock_ctr_set[ep];
+	usb_mock_ctr_set[ep] = 0;
+	usb_mock_epr[ep] = (val & EPR_RW) | (old & SETUP) |
+					   (old & val & (CTR_RX | CTR_TX)) | ((old ^ val) & EPR_TOGGLE);
+}
+//-----------------------------------------------------------------------------
+// apply the values stored into the latches
+//-----------------------------------------------------------------------------
+void Usb_mock_sync(void)
+{
+	for (int reg = 0; reg < USB_MOCK_LATCHED; reg++)
+	{
+		if ( !(latch_used & (1u << reg)) )
+			continue;
+		usb_reg_t val = latch[reg];
+		if ( (val & 0xFFFF0000) != LATCH_MARK )
+			Store(reg, (uint16_t)val);
+		else if ( (uint16_t)val != latch_read[reg] )
+			usb_mock_rmw++; // on the hardware this would toggle bits
+	}
+	latch_used = 0;
+}
+//-----------------------------------------------------------------------------
+volatile usb_reg_t * Usb_mock_reg(int reg)
+{
+	Usb_mock_sync();
+	latch_read[reg] = (reg==USB_MOCK_ISTR) ? Istr_read() : usb_mock_epr[reg - USB_MOCK_EP0R];
+	latch[reg] = LATCH_MARK | latch_read[reg];
+	latch_used |= 1u << reg;
+	return &latch[reg];
+}
@@ -0,0 +1,26 @@
+/*
+ * usb_mock.h
+ *
+ * Host test: USB device registers and packet memory of F1/F3. An EPnR store
+ * toggles the STAT and DTOG bits written as 1 and clears the CTR bits written
+ * as 0, an ISTR store clears the flags written as 0. CTR, DIR and EP_ID of
+ * ISTR follow the CTR bits of the endpoints, as on the hardware.
+ */
+
+#ifndef USB_MOCK_H
+#define USB_MOCK_H
+
+#include <stdint.h>
+
+extern uint16_t usb_mock_epr[8];		// the endpoint registers, valid after Usb_mock_sync()
+extern uint16_t usb_mock_istr;			// the flags of ISTR (bits 8..14)
+extern uint16_t usb_mock_ctr_set[8];	// CTR bits set by the hardware before the next EPnR store
+extern int usb_mock_rmw;				// stores computed from the latch by |=, &= etc.
+
+// byte "i" of the packet memory, as seen by the USB core
+#define PMA_BYTE(i)		usb_pma[(((i) & ~1) << UMEM_SHIFT) | ((i) & 1)]
+
+extern void Usb_mock_init(void);
+extern void Usb_mock_sync(void);
+
+#endif // USB_MOCK_H
@@ -0,0 +1,191 @@
+#!/usr/bin/env python3
+"""
+Converts a bootloader trace dump into a Chrome trace-event / Perfetto timeline.
+
+Two dump formats are accepted:
+ - the binary event trace ("TRC1 ..." header, see trace_decode.py),
+ - the old text trace: the decimal byte count followed by the raw text,
+   e.g. "->SETUP-STD-GET_DESC-DEV-tx=18-ACK" or "->DATA-rx=64-[1234]".
+
+The text trace has no time stamps except the "[ms]" markers which are logged
+before each page erase. Text tokens in between are spread 1 us apart, so the
+order is kept but the durations are not meaningful.
+
+Usage:
+    trace2timeline.py dump.bin -o upload.json
+
+Open the result with https://ui.perfetto.dev or chrome://tracing.
+"""
+
+import argparse
+import json
+import os
+import re
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import trace_decode  # noqa: E402
+
+PID = 1
+TID_BUS = 1
+TID_FLASH = 100
+TID_SESSION = 101
+
+
+def tid_ep(ep, direction_in):
+    return 10 + 2 * (ep & 0x7F) + (1 if direction_in else 0)
+
+
+class Timeline:
+    def __init__(self):
+        self.events = []
+        self.lanes = {TID_BUS: "USB bus", TID_FLASH: "flash", TID_SESSION: "session"}
+
+    def lane(self, tid):
+        if tid not in self.lanes and tid >= 10:
+            ep = (tid - 10) // 2
+            self.lanes[tid] = "EP%d %s" % (ep, "IN" if (tid & 1) else "OUT")
+        return tid
+
+    def instant(self, ts, tid, name, **args):
+        self.events.append({"name": name, "ph": "i", "s": "t", "ts": ts,
+                            "pid": PID, "tid": self.lane(tid), "args": args})
+
+    def span(self, ts, dur, tid, name, **args):
+        self.events.append({"name": name, "ph": "X", "ts": ts, "dur": max(dur, 0.01),
+                            "pid": PID, "tid": self.lane(tid), "args": args})
+
+    def counter(self, ts, name, **values):
+        self.events.append({"name": name, "ph": "C", "ts": ts, "pid": PID, "args": values})
+
+    def to_json(self):
+        meta = [{"name": "process_name", "ph": "M", "pid": PID,
+                 "args": {"name": "CDC bootloader"}}]
+        for tid, name in sorted(self.lanes.items()):
+            meta.append({"name": "thread_name", "ph": "M", "pid": PID, "tid": tid,
+                         "args": {"name": name}})
+            meta.append({"name": "thread_sort_index", "ph": "M", "pid": PID, "tid": tid,
+                         "args": {"sort_index": tid}})
+        return {"traceEvents": meta + self.events, "displayTimeUnit": "ms"}
+
+
+# ---------------------------------------------------------------------------
+# binary trace
+# ---------------------------------------------------------------------------
+SPANS = {"ERASE_START": ("ERASE_END", "erase"), "WRITE_START": ("WRITE_END", "program")}
+
+
+def convert_binary(data, tl):
+    events, lost, f_cpu = trace_decode.parse_dump(data)
+    open_spans = {}
+    rx_bytes = 0
+    for ev in events:
+        name = ev.name
+        if name in SPANS:
+            open_spans[SPANS[name][0]] = (ev, SPANS[name][1])
+        elif name in ("ERASE_END", "WRITE_END"):
+            start = open_spans.pop(name, None)
+            if start:
+                sev, label = start
+                args = {"page": sev.len} if label == "erase" else {"bytes": sev.len}
+                tl.span(sev.us, ev.us - sev.us, TID_FLASH, label, **args)
+        elif name == "BULK_OUT":
+            rx_bytes += ev.len
+            tl.instant(ev.us, tid_ep(ev.ep, False), "packet", len=ev.len)
+            tl.counter(ev.us, "received bytes", bytes=rx_bytes)
+        elif name == "FRAME":
+            tl.counter(ev.us, "bytes per frame", bytes=ev.len)
+        elif name == "VERIFY_FAIL":
+            tl.instant(ev.us, TID_FLASH, "verify failed", offset=ev.len)
+        elif name == "BULK_IN":
+            tl.instant(ev.us, tid_ep(ev.ep, True), "packet sent")
+        elif name == "SETUP":
+            tl.instant(ev.us, tid_ep(ev.ep, False), "SETUP",
+                       bmRequestType=ev.len >> 8, bRequest=ev.len & 0xFF)
+        elif name in ("CTRL_OUT", "RX"):
+            tl.instant(ev.us, tid_ep(ev.ep, False), name, len=ev.len)
+        elif name in ("CTRL_IN", "TX"):
+            tl.instant(ev.us, tid_ep(ev.ep, True), name, len=ev.len)
+        elif name in ("STALL", "UNSTALL"):
+            tl.instant(ev.us, tid_ep(ev.ep, bool(ev.ep & 0x80)), name)
+        elif name in ("HEADER", "ERROR", "COMPLETE"):
+            tl.instant(ev.us, TID_SESSION, name, value=ev.len)
+        else:
+            tl.instant(ev.us, TID_BUS, name, ep=ev.ep, value=ev.len)
+    if lost:
+        print("warning: %d older records were overwritten on the device" % lost,
+              file=sys.stderr)
+
+
+# ---------------------------------------------------------------------------
+# text trace
+# ---------------------------------------------------------------------------
+TOKEN = re.compile(r"\[(\d+)\]|->|<-|[^-\n\[]+")
+
+
+def convert_text(data, tl):
+    text = data.decode("latin-1")
+    m = re.match(r"\s*(\d+)\r?\n", text)
+    if m:  # strip the byte count
+        text = text[m.end():m.end() + int(m.group(1))]
+
+    base_us = 0.0
+    seq = 0
+    direction_in = False
+    ep = 0
+    for tok in TOKEN.finditer(text):
+        if tok.group(1):
+            base_us = int(tok.group(1)) * 1000.0
+            seq = 0
+            tl.instant(base_us, TID_FLASH, "page erase")
+            continue
+        t = tok.group(0).strip()
+        if not t:
+            continue
+        seq += 1
+        ts = base_us + seq
+        if t in ("->", "<-"):
+            direction_in = (t == "<-")
+            ep = 0
+        elif t in ("SETUP", "OUT", "CTRL"):
+            ep = 0
+            tl.instant(ts, tid_ep(0, direction_in), t)
+        elif t == "DATA":
+            ep = 1
+            tl.instant(ts, tid_ep(1, direction_in), "packet" if not direction_in else "packet sent")
+        elif t.startswith("rx=") or t.startswith("tx="):
+            tl.instant(ts, tid_ep(ep, t[0] == "t"), t[:2], len=int(t[3:] or 0))
+        elif t.startswith("ERR:"):
+            tl.instant(ts, TID_SESSION, "ERROR", value=int(t[4:] or 0))
+        elif t.startswith("~"):
+            tl.instant(ts, TID_SESSION, t.strip("~"))
+        elif t in ("RESET", "SUSP", "WKUP", "setup", "START"):
+            tl.instant(ts, TID_BUS, t)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("dump", help="file with the raw trace dump")
+    ap.add_argument("-o", "--output", help="output JSON file (default: stdout)")
+    args = ap.parse_args()
+
+    with open(args.dump, "rb") as f:
+        data = f.read()
+
+    tl = Timeline()
+    if trace_decode.is_binary_dump(data):
+        convert_binary(data, tl)
+    else:
+        convert_text(data, tl)
+
+    out = json.dumps(tl.to_json(), indent=None, separators=(",", ":"))
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(out)
+    else:
+        print(out)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,170 @@
+#!/usr/bin/env python3
+"""
+Decoder for the binary USB event trace of the bootloader (USB_DEBUG build).
+
+The bootloader dumps the trace over USART1 when any character is received:
+
+    TRC1 <nr of records> <lost records> <F_CPU>\\n
+    <nr of records> x 8 byte records, little endian:
+        uint32 cycles, uint8 event, uint8 ep, uint16 len
+
+Usage:
+    trace_decode.py dump.bin            print one line per event
+    trace_decode.py --port /dev/ttyUSB0 request a dump and print it
+
+The event numbers must match trace_event_t in src/usb_trace.h.
+"""
+
+import argparse
+import struct
+import sys
+
+EVENTS = [
+    "NONE",
+    "RESET",
+    "SUSPEND",
+    "WAKEUP",
+    "SETUP",
+    "CTRL_OUT",
+    "CTRL_IN",
+    "BULK_OUT",
+    "BULK_IN",
+    "RX",
+    "TX",
+    "STALL",
+    "UNSTALL",
+    "SET_ADDRESS",
+    "SET_CONFIG",
+    "HEADER",
+    "ERROR",
+    "ERASE_START",
+    "ERASE_END",
+    "WRITE_START",
+    "WRITE_END",
+    "COMPLETE",
+    "FRAME",
+    "VERIFY_FAIL",
+]
+
+REC = struct.Struct("<IBBH")
+MAGIC = b"TRC1 "
+
+
+class Event:
+    __slots__ = ("index", "cycles", "us", "event", "name", "ep", "len")
+
+    def __init__(self, index, cycles, us, event, ep, length):
+        self.index = index
+        self.cycles = cycles
+        self.us = us
+        self.event = event
+        self.name = EVENTS[event] if event < len(EVENTS) else "EV_%d" % event
+        self.ep = ep
+        self.len = length
+
+
+def is_binary_dump(data):
+    """Returns true if data starts with a binary trace header."""
+    return data.lstrip(b"\r\n").startswith(MAGIC)
+
+
+def parse_dump(data):
+    """Parses a binary dump. Returns (events, lost, f_cpu)."""
+    data = data.lstrip(b"\r\n")
+    if not data.startswith(MAGIC):
+        raise ValueError("not a binary trace dump (missing 'TRC1' header)")
+    eol = data.index(b"\n")
+    fields = data[len(MAGIC):eol].split()
+    count, lost, f_cpu = int(fields[0]), int(fields[1]), int(fields[2])
+    body = data[eol + 1:]
+    if len(body) < count * REC.size:
+        print("warning: dump truncated, %d of %d records"
+              % (len(body) // REC.size, count), file=sys.stderr)
+        count = len(body) // REC.size
+
+    events = []
+    base = None
+    prev = 0
+    total = 0
+    for i in range(count):
+        cycles, event, ep, length = REC.unpack_from(body, i * REC.size)
+        if base is None:
+            base = cycles
+            prev = cycles
+        # the 32 bit cycle counter wraps after 2^32 cycles, unwrap it
+        total += (cycles - prev) & 0xFFFFFFFF
+        prev = cycles
+        events.append(Event(lost + i, cycles, total * 1e6 / f_cpu, event, ep, length))
+    return events, lost, f_cpu
+
+
+def describe(ev):
+    """Returns a human readable description of the event specific value."""
+    if ev.name == "SETUP":
+        return "bmRequestType=0x%02X bRequest=%d" % (ev.len >> 8, ev.len & 0xFF)
+    if ev.name in ("STALL", "UNSTALL"):
+        return "ep_addr=0x%02X" % ev.ep
+    if ev.name == "HEADER":
+        return "id=0x%02X" % ev.len
+    if ev.name in ("ERASE_START", "ERASE_END"):
+        return "page=%d" % ev.len
+    if ev.name == "COMPLETE":
+        return "pages=%d" % ev.len
+    if ev.name == "FRAME":
+        return "bytes=%d" % ev.len
+    if ev.name == "VERIFY_FAIL":
+        return "offset=0x%X" % ev.len
+    return "len=%d" % ev.len
+
+
+def read_port(port, baud):
+    try:
+        import serial  # pyserial
+    except ImportError:
+        sys.exit("reading from a serial port needs pyserial")
+    with serial.Serial(port, baud, timeout=1) as ser:
+        ser.reset_input_buffer()
+        ser.write(b"p")
+        data = b""
+        while True:
+            chunk = ser.read(4096)
+            if not chunk:
+                break
+            data += chunk
+    return data
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("dump", nargs="?", help="file with the raw dump")
+    ap.add_argument("--port", help="serial port connected to USART1")
+    ap.add_argument("--baud", type=int, default=230400)
+    ap.add_argument("--save", help="save the raw dump read from --port")
+    args = ap.parse_args()
+
+    if args.port:
+        data = read_port(args.port, args.baud)
+        if args.save:
+            with open(args.save, "wb") as f:
+                f.write(data)
+    elif args.dump:
+        with open(args.dump, "rb") as f:
+            data = f.read()
+    else:
+        ap.error("either a dump file or --port is needed")
+
+    events, lost, f_cpu = parse_dump(data)
+    if lost:
+        print("# %d older records were overwritten" % lost)
+    print("# %d records, F_CPU=%d" % (len(events), f_cpu))
+    prev = None
+    for ev in events:
+        delta = ev.us - prev if prev is not None else 0.0
+        prev = ev.us
+        print("%6d %12.2f us %+10.2f  %-12s ep=%-3d %s"
+              % (ev.index, ev.us, delta, ev.name, ev.ep, describe(ev)))
+
+
+if __name__ == "__main__":
+    main()